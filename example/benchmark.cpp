@@ -0,0 +1,407 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+// g++ -I include -m64 -std=c++23 -s -Wall -O3 -o /tmp/benchmark example/benchmark.cpp
+
+#include <map>
+#include <set>
+#include <list>
+#include <array>
+#include <deque>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <forward_list>
+#include <memory_resource>
+#include <unordered_map>
+#include <unordered_set>
+#include <codec.hpp>
+#include <reflect.hpp>
+
+// every heap allocation made by the process is counted
+// the replacements stay out of line, inlined into the callers GCC pairs their malloc and free with the new expressions
+
+static size_t allocations = 0;
+
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    ++allocations;
+
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// std::pmr::new_delete_resource allocates through the aligned forms
+
+[[gnu::noinline]] void* operator new(size_t size, std::align_val_t align)
+{
+    ++allocations;
+
+    size_t a = size_t(align);
+    size_t n = (size + a - 1) / a * a;
+
+    if (void* p = std::aligned_alloc(a, n ? n : a))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+struct X
+{
+    float f;
+    std::string s;
+};
+
+struct Z
+{
+    int i;
+    double d;
+    char c;
+    X x;
+    X* ptr;
+    std::string s;
+    std::list<int> ages;
+    std::deque<std::string> names;
+    std::vector<X> xs;
+    std::forward_list<std::vector<int>> ints;
+    std::shared_ptr<X> sp;
+    std::array<X, 3> arrs;
+    std::set<int> sets;
+    std::map<int, std::string> maps;
+    std::multiset<int> multisets;
+    std::multimap<int, std::string> multimaps;
+    std::unordered_set<int> unordered_sets;
+    std::unordered_map<int, std::string> unordered_maps;
+    std::unordered_multiset<int> unordered_multisets;
+    std::unordered_multimap<int, std::string> unordered_multimaps;
+};
+
+// a small rpc message, mostly lengths and small integers
+
+// padded, so it is sized member by member, yet every one has the same encoded size
+
+struct Level
+{
+    int32_t qty;
+    double price;
+};
+
+struct Call
+{
+    int64_t id;
+    int32_t method;
+    std::string name;
+    std::vector<int64_t> args;
+    std::map<int32_t, std::string> meta;
+};
+
+// Z with pmr containers, decodable into a caller supplied memory resource
+
+struct PX
+{
+    float f;
+    std::pmr::string s;
+};
+
+struct PZ
+{
+    int i;
+    double d;
+    char c;
+    PX x;
+    PX* ptr;
+    std::pmr::string s;
+    std::pmr::list<int> ages;
+    std::pmr::vector<std::pmr::string> names;
+    std::pmr::vector<PX> xs;
+    std::shared_ptr<PX> sp;
+    std::pmr::map<int, std::pmr::string> maps;
+    std::pmr::unordered_map<int, std::pmr::string> unordered_maps;
+};
+
+// run f n times, report the average time and the number of allocations per run
+
+template <typename F>
+void measure(const char* name, size_t n, F&& f)
+{
+    size_t a = allocations;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i != n; ++i)
+         f();
+
+    auto stop = std::chrono::steady_clock::now();
+    auto ns = std::chrono::duration<double, std::nano>(stop - start).count();
+
+    std::printf("%-40s %12.1f ns/op %8.2f allocs/op\n", name, ns / n, double(allocations - a) / n);
+}
+
+int main(int argc, char* argv[])
+{
+    X x { 21.3f, "metaprogramming with a string long enough to live on the heap" };
+
+    std::vector<int> v1 { 0, 1, 2, 3 };
+    std::vector<int> v2 { 4, 5, 6, 7, 8 };
+
+    Z z { 18, 9.87, '*', x, &x, "TMP", { 1, 3, 6 }, { "smp", "C++", "template" }, { x, x, x }, { v1, v2 },
+          std::make_shared<X>(15.18f, "reflect"), { x, x, x }, { 3, 2, 5 }, { { 2, "two" }, { 1, "one" } },
+          { 3, 2, 2 }, { { 4, "four" }, { 4, "four2" } }, { 3, 2, 5 }, { { 2, "two" }, { 1, "one" } },
+          { 4, 3, 3 }, { { 5, "two" }, { 2, "one" } } };
+
+    constexpr size_t n = 100000;
+
+    // the output is sized once, so marshaling into a fresh string allocates exactly once
+
+    measure("marshal Z into a fresh std::string", n, [&]
+    {
+        auto s = smp::marshal(z);
+        asm volatile("" : : "r"(s.data()) : "memory");
+    });
+
+    std::string buffer;
+
+    measure("marshal Z into a reused std::string", n, [&]
+    {
+        buffer.clear();
+        smp::marshal(buffer, z);
+    });
+
+    measure("size_bytes Z", n, [&]
+    {
+        auto size = smp::size_bytes(z);
+        asm volatile("" : : "r"(size) : "memory");
+    });
+
+    // fixed width against compact encodings
+
+    Call call { 1024, 7, "get", { 1, -2, 300, 40000 }, { { 1, "a" }, { 2, "bc" } } };
+
+    constexpr smp::policy zigzag { .varint = 1, .zigzag = 1 };
+
+    std::printf("\n%-40s %8zu bytes\n", "encoded Call, fixed width", smp::size_bytes(call));
+    std::printf("%-40s %8zu bytes\n", "encoded Call, varint lengths", smp::size_bytes<smp::compact>(call));
+    std::printf("%-40s %8zu bytes\n\n", "encoded Call, zigzag integers", smp::size_bytes<zigzag>(call));
+
+    std::string cs = smp::marshal(call);
+    std::string vs = smp::marshal<smp::compact>(call);
+    std::string zs = smp::marshal<zigzag>(call);
+
+    measure("marshal Call, fixed width", n, [&]
+    {
+        buffer.clear();
+        smp::marshal(buffer, call);
+    });
+
+    measure("marshal Call, varint lengths", n, [&]
+    {
+        buffer.clear();
+        smp::marshal<smp::compact>(buffer, call);
+    });
+
+    measure("marshal Call, zigzag integers", n, [&]
+    {
+        buffer.clear();
+        smp::marshal<zigzag>(buffer, call);
+    });
+
+    measure("unmarshal Call, fixed width", n, [&]
+    {
+        auto c = smp::unmarshal<Call>(cs);
+        asm volatile("" : : "r"(&c) : "memory");
+    });
+
+    measure("unmarshal Call, varint lengths", n, [&]
+    {
+        auto c = smp::unmarshal<smp::compact, Call>(vs);
+        asm volatile("" : : "r"(&c) : "memory");
+    });
+
+    measure("unmarshal Call, zigzag integers", n, [&]
+    {
+        auto c = smp::unmarshal<zigzag, Call>(zs);
+        asm volatile("" : : "r"(&c) : "memory");
+    });
+
+    // rebuilding large associative containers
+
+    std::map<int32_t, int64_t> big;
+    std::unordered_map<int32_t, int64_t> hashed;
+
+    for (int32_t i = 0; i != 1 << 16; ++i)
+    {
+         big.emplace(i * 3, i);
+         hashed.emplace(i * 3, i);
+    }
+
+    std::string bs = smp::marshal(big);
+    std::string hs = smp::marshal(hashed);
+
+    std::printf("\n");
+
+    measure("unmarshal std::map, 65536 entries", 100, [&]
+    {
+        auto m = smp::unmarshal<std::map<int32_t, int64_t>>(bs);
+        asm volatile("" : : "r"(&m) : "memory");
+    });
+
+    measure("unmarshal std::unordered_map, 65536 entries", 100, [&]
+    {
+        auto m = smp::unmarshal<std::unordered_map<int32_t, int64_t>>(hs);
+        asm volatile("" : : "r"(&m) : "memory");
+    });
+
+    // block compression of marshaled output, ratio and throughput
+
+    std::string zstr = smp::marshal(z);
+
+    std::vector<int32_t> counts(1 << 20);
+    std::vector<double> prices(1 << 20);
+
+    for (size_t i = 0; i != counts.size(); ++i)
+    {
+         counts[i] = i % 64 ? 0 : int32_t(i);
+         prices[i] = 100.0 + (i / 256) * 0.25;
+    }
+
+    std::string ns = smp::marshal(smp::make_fuple(counts, prices));
+
+    auto codec = [&]<typename Codec>(const char* name, const std::string& raw, size_t n)
+    {
+        std::string packed = smp::compress<Codec>(raw);
+        std::printf("\n%-40s %8zu -> %zu bytes, %.2fx\n", name, raw.size(), packed.size(), double(raw.size()) / packed.size());
+
+        auto mbs = [&](const char* what, auto f)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i != n; ++i)
+                 f();
+
+            auto s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::printf("  %-38s %12.1f MB/s\n", what, raw.size() * n / s / 1e6);
+        };
+
+        mbs("compress", [&]
+        {
+            auto c = smp::compress<Codec>(raw);
+            asm volatile("" : : "r"(c.data()) : "memory");
+        });
+
+        mbs("decompress", [&]
+        {
+            auto d = smp::decompress<Codec>(packed);
+            asm volatile("" : : "r"(d.data()) : "memory");
+        });
+    };
+
+    codec.template operator()<smp::lz>("lz, Z", zstr, 100000);
+    codec.template operator()<smp::rle>("rle, Z", zstr, 100000);
+
+    codec.template operator()<smp::lz>("lz, numeric vectors", ns, 20);
+    codec.template operator()<smp::rle>("rle, numeric vectors", ns, 20);
+
+    // decoding into a monotonic arena instead of the global heap
+
+    std::pmr::string ls = "a string long enough to live on the heap, or in the arena";
+
+    PX px { 3.5f, ls };
+    PZ pz { 18, 9.87, '*', px, &px, ls };
+
+    pz.ages = { 1, 3, 6 };
+    pz.names.assign(3, ls);
+
+    pz.xs.assign(2, px);
+    pz.sp = std::make_shared<PX>(px);
+
+    pz.maps = { { 2, ls }, { 1, ls } };
+    pz.unordered_maps = { { 5, ls }, { 2, ls } };
+
+    std::string ps = smp::marshal(pz);
+
+    std::printf("\n");
+
+    measure("unmarshal PZ, global heap", n, [&]
+    {
+        auto z = smp::unmarshal<PZ>(ps);
+        delete z.ptr;
+    });
+
+    alignas(std::max_align_t) static std::byte arena[1 << 16];
+
+    measure("unmarshal PZ, monotonic arena", n, [&]
+    {
+        std::pmr::monotonic_buffer_resource mr(arena, sizeof(arena), std::pmr::null_memory_resource());
+
+        auto z = smp::unmarshal<PZ>(ps, &mr);
+        asm volatile("" : : "r"(&z) : "memory");
+    });
+
+    // sizing containers of elements of constant size against marshaling them
+
+    std::vector<double> doubles(10000000, 1.5);
+    std::deque<double> dq(doubles.begin(), doubles.begin() + 1000000);
+
+    std::vector<Level> levels(1000000, Level{ 5, 10.25 });
+    std::map<int, int> imap;
+
+    for (int i = 0; i != 1000000; ++i)
+         imap.emplace_hint(imap.end(), i, -i);
+
+    std::array<Level, 512> book{};
+
+    auto sizing = [&](const char* name, const auto& t, size_t n)
+    {
+        std::printf("\n");
+        std::string s;
+
+        measure((std::string("size_bytes ") + name).c_str(), n, [&]
+        {
+            auto k = smp::size_bytes(t);
+            asm volatile("" : : "r"(k) : "memory");
+        });
+
+        measure((std::string("marshal ") + name).c_str(), n, [&]
+        {
+            s.clear();
+            smp::marshal(s, t);
+        });
+    };
+
+    sizing("vector<double>, 10M", doubles, 5);
+    sizing("deque<double>, 1M", dq, 10);
+    sizing("vector<Level>, 1M", levels, 10);
+    sizing("map<int, int>, 1M", imap, 10);
+    sizing("array<Level, 512>", book, 10000);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+// g++ -I include -m64 -std=c++23 -s -Wall -O3 -o /tmp/codec example/codec.cpp
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <codec.hpp>
+#include <decoder.hpp>
+
+struct X
+{
+    float f;
+    std::string s;
+};
+
+struct Y
+{
+    int32_t i;
+    X x;
+    std::vector<int64_t> ids;
+    std::vector<double> zeros;
+    std::map<int, std::string> names;
+};
+
+template <typename Codec>
+void check(std::string_view s)
+{
+    auto c = smp::compress<Codec>(s);
+    assert(smp::decompress<Codec>(c) == s);
+
+    // fed one byte at a time, blocks come out whole
+    std::string r;
+    smp::decompressor<Codec> d;
+
+    for (char b : c)
+         d.feed(&b, 1, [&](const char* p, size_t n){ r.append(p, n); });
+
+    assert(d.done() && r == s);
+}
+
+int main(int argc, char* argv[])
+{
+    std::mt19937_64 g(2022);
+
+    std::string random(200000, 0);
+    std::string text;
+
+    for (auto& c : random)
+         c = char(g());
+
+    while (text.size() < 200000)
+           text += "smp marshals and unmarshals reflected aggregates, fuples and STL containers; ";
+
+    std::string sparse(300000, 0);
+
+    for (size_t i = 0; i < sparse.size(); i += 97)
+         sparse[i] = char(i);
+
+    for (std::string_view s : { std::string_view(), std::string_view("a"), std::string_view("aaaa"), std::string_view(random), std::string_view(text), std::string_view(sparse) })
+    {
+         check<smp::rle>(s);
+         check<smp::lz>(s);
+    }
+
+    assert(smp::compress<smp::rle>(sparse).size() * 10 < sparse.size());
+    assert(smp::compress<smp::lz>(text).size() * 10 < text.size());
+
+    assert(smp::compress<smp::lz>(random).size() <= random.size() + 4 * smp::block_header);
+
+    // block headers are little endian on every host, a stored block of 3 bytes starts with 03 00 00 00 03 00 00 00
+
+    assert(smp::compress<smp::rle>(std::string_view("abc")) == std::string("\3\0\0\0\3\0\0\0abc", 11));
+
+    // truncated or corrupted input is reported, not unpacked
+
+    auto c = smp::compress<smp::lz>(text);
+
+    assert(smp::decompress<smp::lz>(std::string_view(c).substr(0, c.size() - 1)).empty());
+
+    c[smp::block_header + 5] ^= 0x5a;
+    c[smp::block_header + 9] ^= 0x5a;
+
+    smp::decompress<smp::lz>(c);
+
+    // marshal straight into a compressor, and unmarshal while unpacking
+
+    Y y { 7, { 1.5f, "compressed" } };
+
+    for (int64_t i = 0; i != 50000; ++i)
+         y.ids.push_back(1000000 + i);
+
+    y.zeros.assign(50000, 0.0);
+    y.names = { { 1, "one" }, { 2, "two" } };
+
+    std::string ys = smp::marshal(y);
+    std::string packed;
+
+    smp::chunk_sink cs([&](const char* p, size_t n)
+    {
+        packed.append(p, n);
+    }, 4096);
+
+    smp::compressor<smp::lz, decltype(cs)> z(cs);
+
+    smp::marshal(z, y);
+    z.flush();
+
+    assert(z.length() == ys.size());
+    assert(smp::decompress<smp::lz>(packed) == ys);
+
+    smp::decoder<Y> d;
+    smp::decompressor<smp::lz> u;
+
+    for (size_t i = 0; i < packed.size(); i += 1000)
+    {
+         u.feed(std::string_view(packed).substr(i, 1000), [&](const char* p, size_t n)
+         {
+             d.feed(p, n);
+         });
+    }
+
+    assert(d.done());
+    assert(d.value().ids == y.ids && d.value().names == y.names);
+
+    std::cout << ys.size() << " bytes packed into " << packed.size() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+// g++ -I include -m64 -std=c++23 -s -Wall -O3 -o /tmp/decoder example/decoder.cpp
+
+#include <map>
+#include <list>
+#include <array>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <variant>
+#include <optional>
+#include <stdexcept>
+#include <decoder.hpp>
+
+struct X
+{
+    float f;
+    std::string s;
+};
+
+struct Z
+{
+    int32_t i;
+    int32_t j;
+    double d;
+    X x;
+    X* ptr;
+    std::list<int> ages;
+    std::vector<X> xs;
+    std::vector<float> floats;
+    std::shared_ptr<X> sp;
+    std::array<X, 2> arrs;
+    std::map<int, std::string> maps;
+    std::tuple<int, std::string> tp;
+};
+
+struct Event
+{
+    int32_t id;
+    std::variant<int64_t, std::string, X> body;
+    std::vector<std::variant<int64_t, std::string, X>> more;
+};
+
+int main(int argc, char* argv[])
+{
+    X x { 21.3f, "metaprogramming" };
+
+    Z z { 18, 19, 9.87, x, &x, { 1, 3, 6 }, { x, x, x }, { 1.5f, 2.5f, 3.5f, 4.5f }, std::make_shared<X>(15.18f, "reflect"),
+          { x, x }, { { 1, "one" }, { 2, "two" } }, { 7, "seven" } };
+
+    std::string zs = smp::marshal(z);
+
+    // feed the encoding a few bytes at a time, as it would arrive from a socket
+
+    for (size_t step : { 1, 3, 7, 64 })
+    {
+        smp::decoder<Z> d;
+        smp::status state = smp::status::more;
+
+        for (size_t i = 0; i < zs.size() && state == smp::status::more; i += step)
+             state = d.feed(std::string_view(zs).substr(i, step));
+
+        assert(state == smp::status::done);
+        assert(smp::marshal(d.value()) == zs);
+
+        delete d.value().ptr;
+    }
+
+    // back to back messages in one chunk, consumed() tells where the next one starts
+
+    std::string two = smp::marshal(x) + smp::marshal(X{ 42.0f, "next" });
+
+    smp::decoder<X> d1;
+    smp::decoder<X> d2;
+
+    size_t messages = d1.feed(two) == smp::status::done;
+    messages += d2.feed(std::string_view(two).substr(d1.consumed())) == smp::status::done;
+
+    assert(messages == 2);
+
+    assert(d1.value().s == "metaprogramming");
+    assert(d2.value().s == "next");
+
+    // the frames of string elements are recycled, one after another
+
+    std::vector<std::string> words(1000, "word");
+    std::string ws = smp::marshal(words);
+
+    smp::decoder<std::vector<std::string>> dw;
+
+    for (size_t i = 0; i < ws.size(); i += 5)
+         dw.feed(std::string_view(ws).substr(i, 5));
+
+    assert(dw.done() && dw.value() == words);
+
+    // the alternative of a variant is known once its index has arrived, an index past the alternatives is refused
+
+    Event ev { 3, X{ 1.5f, "nested" }, { int64_t(7), std::string("text"), X{ 2.5f, "last" } } };
+    std::string es = smp::marshal(ev);
+
+    smp::decoder<Event> de;
+
+    for (size_t i = 0; i < es.size(); i += 3)
+         de.feed(std::string_view(es).substr(i, 3));
+
+    assert(de.done() && smp::marshal(de.value()) == es);
+    assert(std::get<2>(de.value().body).s == "nested" && std::get<1>(de.value().more[1]) == "text");
+
+    es[sizeof(int32_t)] = 9;
+
+    smp::decoder<Event> bad;
+    bool refused = 0;
+
+    try
+    {
+        bad.feed(es);
+    }
+    catch (const std::invalid_argument&)
+    {
+        refused = 1;
+    }
+
+    assert(refused);
+
+    std::cout << "decoded " << zs.size() << " bytes incrementally, " << messages << " messages back to back, bad variant refused " << refused << std::endl;
+
+    return 0;
+}
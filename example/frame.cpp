@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+// g++ -I include -m64 -std=c++23 -s -Wall -O3 -o /tmp/frame example/frame.cpp
+
+#include <map>
+#include <list>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <frame.hpp>
+
+struct Fill
+{
+    int64_t id;
+    double price;
+    std::string venue;
+    std::vector<int32_t> qty;
+    std::map<int32_t, std::string> tags;
+};
+
+struct Fill2
+{
+    int64_t id;
+    double price;
+    std::string venue;
+    std::vector<int64_t> qty;
+    std::map<int32_t, std::string> tags;
+};
+
+int main(int argc, char* argv[])
+{
+    // the check value of crc32c, and the same crc taken in pieces
+
+    std::string_view digits("123456789");
+
+    assert(smp::crc32c(0, digits.data(), digits.size()) == 0xe3069283);
+    assert(smp::crc32c(smp::crc32c(0, digits.data(), 4), digits.data() + 4, 5) == 0xe3069283);
+
+    std::string big(100003, 0);
+
+    for (size_t i = 0; i != big.size(); ++i)
+         big[i] = char(i * 31 + (i >> 7));
+
+    uint32_t whole = smp::crc32c(0, big.data(), big.size());
+    uint32_t part = 0;
+
+    for (size_t i = 0; i < big.size(); i += 777)
+         part = smp::crc32c(part, big.data() + i, std::min<size_t>(777, big.size() - i));
+
+    assert(part == whole);
+
+    uint32_t bytewise = ~0u;
+
+    for (unsigned char c : big)
+    {
+         bytewise ^= c;
+
+         for (int k = 0; k != 8; ++k)
+              bytewise = bytewise >> 1 ^ (bytewise & 1 ? 0x82f63b78 : 0);
+    }
+
+    assert(~bytewise == whole);
+
+    // the table driven fallback agrees with whichever path the running cpu took
+
+    assert(~smp::crc32c_slice8(~0u, reinterpret_cast<const unsigned char*>(big.data()), big.size()) == whole);
+
+    // frames are checked as they are unmarshaled, back to back in one buffer
+
+    Fill f { 42, 101.25, "XNAS", { 100, 200, 300 }, { { 1, "open" }, { 2, "close" } } };
+
+    std::string s = smp::marshal_framed(f);
+
+    assert(s.size() == smp::framed_size_bytes(f));
+    assert(s.substr(smp::frame_header, s.size() - smp::frame_header - smp::frame_trailer) == smp::marshal(f));
+
+    f.id = 43;
+    smp::marshal_framed(s, f);
+
+    size_t l = 0;
+    size_t frames = 0;
+
+    Fill g;
+
+    for (int64_t id = 42; smp::unmarshal_framed(l, s, g); ++id, ++frames)
+         assert(g.id == id && g.tags == f.tags);
+
+    assert(frames == 2 && l == s.size());
+
+    // a flipped bit, a truncated frame and a frame of another type are all rejected
+
+    std::string bad = smp::marshal_framed(f);
+    bad[smp::frame_header + 3] ^= 0x10;
+
+    assert(!smp::unmarshal_framed<Fill>(bad));
+    assert(!smp::unmarshal_framed<Fill>(std::string_view(s).substr(0, 20)));
+
+    // the fingerprint follows the reflected members rather than the names of the types
+
+    static_assert(smp::fingerprint_v<Fill> != smp::fingerprint_v<Fill2>);
+    static_assert(smp::fingerprint_v<std::vector<int32_t>> == smp::fingerprint_v<std::list<int32_t>>);
+
+    assert(!smp::unmarshal_framed<Fill2>(smp::marshal_framed(f)));
+
+    // framing a sink checksums the bytes on their way out
+
+    std::string chunks;
+
+    smp::chunk_sink cs([&](const char* p, size_t n)
+    {
+        chunks.append(p, n);
+    }, 16);
+
+    smp::marshal_framed<smp::portable>(cs, f);
+    cs.flush();
+
+    assert(chunks == smp::marshal_framed<smp::portable>(f));
+
+    auto h = smp::unmarshal_framed<smp::portable, Fill>(chunks);
+    assert(h && h->venue == "XNAS" && h->qty == f.qty);
+
+    std::cout << s.size() << " bytes in " << frames << " frames, crc32c " << std::hex << whole << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+// g++ -I include -m64 -std=c++23 -s -Wall -O3 -o /tmp/parallel example/parallel.cpp
+
+#include <map>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <stdexcept>
+#include <parallel.hpp>
+
+struct Leg
+{
+    int32_t ratio;
+    double price;
+};
+
+struct Trade
+{
+    int64_t id;
+    double price;
+    std::string venue;
+    std::vector<Leg> legs;
+};
+
+// the number of thread counts under which marshal_parallel matches marshal
+
+template <smp::policy P, typename T>
+size_t check(const T& t)
+{
+    std::string s = smp::marshal<P>(t);
+    size_t same = 0;
+
+    for (size_t threads : { 1, 2, 3, 8, 32 })
+         same += smp::marshal_parallel<P>(t, threads) == s;
+
+    // appended after what is already there
+    std::string r("prefix");
+    smp::marshal_parallel<P>(r, t, 5);
+
+    return same + (r == "prefix" + s);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = 200000;
+
+    std::vector<Trade> trades;
+    trades.reserve(n);
+
+    for (size_t i = 0; i != n; ++i)
+         trades.push_back({ int64_t(i) - 1000, i * 0.25, std::string(i % 13, char('a' + i % 26)), std::vector<Leg>(i % 4, Leg{ int32_t(i), 1.5 }) });
+
+    size_t matched = check<smp::policy{}>(trades) + check<smp::compact>(trades) + check<smp::portable>(trades);
+
+    matched += check<smp::policy{ .zigzag = 1 }>(trades);
+    matched += check<smp::policy{ .tagged = 1 }>(trades);
+
+    // bitwise elements, copied a block at a time, and containers that stay serial
+    std::vector<Leg> legs(n, Leg{ 3, 4.5 });
+    std::deque<int32_t> ints(n, 7);
+
+    matched += check<smp::policy{}>(legs) + check<smp::portable>(legs) + check<smp::policy{}>(ints);
+    matched += check<smp::policy{ .columnar = 1 }>(trades);
+
+    assert(matched == 9 * 6);
+
+    // an exception thrown on any chunk reaches the caller once every chunk has run
+
+    std::atomic<size_t> ran = 0;
+    bool caught = 0;
+
+    try
+    {
+        smp::parallel_for(16, [&](size_t i)
+        {
+            ++ran;
+
+            if (i == 5)
+                throw std::runtime_error("chunk 5");
+        });
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = 1;
+    }
+
+    assert(caught && ran == 16);
+
+    assert(smp::unmarshal<std::vector<Trade>>(smp::marshal_parallel(trades, 4))[n - 1].venue == trades[n - 1].venue);
+
+    // an indexed container carries block offsets after its encoding, so it unmarshals on several threads
+
+    for (size_t threads : { 1, 3, 8 })
+    {
+         std::string is = smp::marshal_indexed(trades, threads);
+
+         assert(is.starts_with(smp::marshal(trades)));
+         assert(smp::unmarshal<std::vector<Trade>>(is).size() == n);
+
+         for (size_t k : { 1, 2, 7, 64 })
+         {
+              auto back = smp::unmarshal_indexed<std::vector<Trade>>(is, k);
+              assert(back.size() == n && smp::marshal(back) == smp::marshal(trades));
+         }
+    }
+
+    auto ps = smp::marshal_indexed<smp::portable>(legs);
+    assert((smp::unmarshal_indexed<smp::portable, std::vector<Leg>>(ps, 4).size() == n));
+
+    // too few elements for a block, and containers indexed with no offsets
+
+    std::vector<Trade> few(trades.begin(), trades.begin() + 10);
+    assert(smp::unmarshal_indexed<std::vector<Trade>>(smp::marshal_indexed(few)).size() == 10);
+
+    std::vector<Trade> none;
+    assert(smp::unmarshal_indexed<std::vector<Trade>>(smp::marshal_indexed(none)).empty());
+
+    std::map<int, std::string> names { { 1, "one" }, { 2, "two" } };
+    assert((smp::unmarshal_indexed<std::map<int, std::string>>(smp::marshal_indexed(names)) == names));
+
+    // a resource that isn't thread safe is only ever used from the calling thread
+
+    std::pmr::vector<std::pmr::string> words(n, "a word too long for small string storage");
+    std::pmr::monotonic_buffer_resource arena;
+
+    std::pmr::vector<std::pmr::string> words2(&arena);
+    smp::unmarshal_indexed(smp::marshal_indexed(words, 4), words2, 4, &arena);
+
+    assert(words2 == words && words2.back().get_allocator().resource() == &arena);
+
+    // a trailer that doesn't fit the input or the container is refused before anything is decoded
+
+    std::string ts = smp::marshal_indexed(trades, 4);
+    size_t refused = 0;
+
+    auto corrupt = [&](std::string bad)
+    {
+        try
+        {
+            smp::unmarshal_indexed<std::vector<Trade>>(bad, 4);
+        }
+        catch (const std::out_of_range&)
+        {
+            ++refused;
+        }
+    };
+
+    std::string big_count = ts;
+    big_count[big_count.size() - 1] = 0x7f;
+
+    std::string no_stride = ts;
+    no_stride.replace(no_stride.size() - 16, 8, 8, 0);
+
+    std::string far_offset = ts;
+    far_offset.replace(far_offset.size() - 24, 8, 8, char(0xff));
+
+    for (auto bad : { ts.substr(0, 7), big_count, no_stride, far_offset })
+         corrupt(bad);
+
+    assert(refused == 4);
+
+    size_t threads = std::thread::hardware_concurrency();
+
+    auto time = [](auto&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::string s;
+
+    double serial = time([&]{ s = smp::marshal(trades); });
+    double parallel = time([&]{ s = smp::marshal_parallel(trades, threads); });
+
+    std::cout << n << " trades, serial " << serial << " ms, " << threads << " threads " << parallel << " ms" << std::endl;
+
+    std::vector<Trade> back;
+    std::string is = smp::marshal_indexed(trades, threads);
+
+    serial = time([&]{ back = smp::unmarshal<std::vector<Trade>>(s); });
+    parallel = time([&]{ back = smp::unmarshal_indexed<std::vector<Trade>>(is, threads); });
+
+    std::cout << n << " trades back, serial " << serial << " ms, " << threads << " threads " << parallel << " ms" << std::endl;
+    std::cout << refused << " corrupt indexes refused" << std::endl;
+    std::cout << matched << " parallel encodings matched, " << ran << " chunks ran around an exception caught " << caught << std::endl;
+
+    return 0;
+}
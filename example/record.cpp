@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+// g++ -I include -m64 -std=c++23 -s -Wall -O3 -o /tmp/record example/record.cpp
+
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <record.hpp>
+
+struct Trade
+{
+    int64_t id;
+    double price;
+    std::string venue;
+    std::vector<int32_t> fills;
+};
+
+int main(int argc, char* argv[])
+{
+    auto path = (std::filesystem::temp_directory_path() / ("smp_record_" + std::to_string(::getpid()))).string();
+
+    constexpr size_t n = 10000;
+
+    auto make = [](size_t i)
+    {
+        return Trade{ int64_t(i), i * 0.5, "venue" + std::to_string(i % 7), std::vector<int32_t>(i % 5, int32_t(i)) };
+    };
+
+    // a small buffer forces several flushes, a second writer appends to the same log
+
+    {
+        smp::record_writer<Trade> w(path, 4096);
+
+        bool good = 1;
+
+        for (size_t i = 0; i != n / 2; ++i)
+             good = w.append(make(i)) && good;
+
+        assert(good);
+    }
+
+    {
+        smp::record_writer<Trade> w(path);
+
+        bool good = 1;
+
+        for (size_t i = n / 2; i != n; ++i)
+             good = w.append(make(i)) && good;
+
+        good = w.flush() && good;
+        assert(good && w);
+    }
+
+    smp::record_reader<Trade> r(path);
+    assert(r.count() == n);
+
+    // random access through the index
+
+    for (size_t i : { size_t(0), size_t(1), n / 2 - 1, n / 2, n - 1, size_t(4242) })
+    {
+         auto t = r[i];
+
+         assert(t.id == int64_t(i));
+         assert(t.venue == make(i).venue && t.fills == make(i).fills);
+
+         assert(r.frame(i) == smp::marshal(make(i)));
+    }
+
+    // a forward scan walks the frames in order
+
+    size_t i = 0;
+
+    for (auto it = r.begin(); it != r.end(); ++it, ++i)
+         assert((*it).id == int64_t(i) && (*it).price == i * 0.5);
+
+    assert(i == n);
+
+    static_assert(std::forward_iterator<smp::record_reader<Trade>::iterator>);
+
+    // a log under an explicit byte order
+
+    {
+        smp::record_writer<Trade, smp::portable> w(path + ".portable");
+        w.append(make(3));
+    }
+
+    smp::record_reader<Trade, smp::portable> p(path + ".portable");
+    assert(p.count() == 1 && p[0].venue == make(3).venue);
+
+    // a writer that died after writing frames but before indexing them leaves frames nobody points to,
+    // the next writer cuts them off so that scanning the log and walking its index agree
+
+    auto crash = path + ".crash";
+
+    {
+        smp::record_writer<Trade> w(crash);
+        w.append(make(0));
+    }
+
+    {
+        uint64_t k = 3;
+        std::string orphan = smp::marshal<smp::frame_policy<smp::policy{}>>(k) + "abc";
+        std::ofstream(crash, std::ios::binary | std::ios::app) << orphan;
+        std::ofstream(crash + ".idx", std::ios::binary | std::ios::app) << "torn";
+    }
+
+    {
+        smp::record_writer<Trade> w(crash);
+
+        w.append(make(1));
+        w.flush();
+
+        assert(w);
+    }
+
+    smp::record_reader<Trade> c(crash);
+    size_t scanned = 0;
+
+    for (auto it = c.begin(); it != c.end(); ++it, ++scanned)
+         assert((*it).id == int64_t(scanned));
+
+    assert(scanned == 2 && c.count() == 2 && c[1].venue == make(1).venue);
+
+    // an index entry that points past the end of the data, and a record past the end of the index,
+    // are refused instead of read out of bounds
+
+    {
+        uint64_t far = uint64_t(1) << 40;
+        std::string stray = smp::marshal<smp::frame_policy<smp::policy{}>>(far);
+        std::ofstream(crash + ".idx", std::ios::binary | std::ios::app) << stray;
+    }
+
+    smp::record_reader<Trade> bad(crash);
+    size_t refused = 0;
+
+    for (size_t k : { size_t(2), size_t(3), size_t(1) << 40 })
+    {
+         try
+         {
+             bad.frame(k);
+         }
+         catch (const std::out_of_range&)
+         {
+             ++refused;
+         }
+    }
+
+    assert(refused == 3);
+
+    std::cout << n << " records in " << std::filesystem::file_size(path) << " bytes, " << scanned << " recovered, stray frames refused " << refused << std::endl;
+
+    for (auto f : { path, path + ".idx", path + ".portable", path + ".portable.idx", crash, crash + ".idx" })
+         std::filesystem::remove(f);
+
+    return 0;
+}
@@ -14,10 +14,15 @@
 #include <list>
 #include <array>
 #include <deque>
+#include <span>
 #include <vector>
 #include <cassert>
+#include <variant>
+#include <optional>
+#include <cstdint>
 #include <iostream>
 #include <forward_list>
+#include <memory_resource>
 #include <unordered_map>
 #include <unordered_set>
 #include <reflect.hpp>
@@ -47,6 +52,141 @@ struct Y
     X x;
 };
 
+// a padding free aggregate of fundamental types is trivially copyable and has no holes
+
+struct Tick
+{
+    int64_t ts;
+    double price;
+    int32_t qty;
+    int32_t side;
+};
+
+// adjacent fundamental members without padding in between are copied as one run
+
+struct Quote
+{
+    int32_t bid;
+    int32_t ask;
+    double price;
+    std::string venue;
+    int64_t seq;
+    int64_t ts;
+};
+
+// std::string_view and std::span<const T> members refer into the unmarshaled buffer
+
+struct Frame
+{
+    int32_t id;
+    std::string_view name;
+    std::span<const float> values;
+};
+
+// two revisions of one message, the second appends members and nests another revision
+
+struct Point
+{
+    int32_t x;
+    int32_t y;
+};
+
+struct Point2
+{
+    int32_t x;
+    int32_t y;
+    int32_t z = -1;
+};
+
+struct Record
+{
+    int64_t id;
+    std::string name;
+    Point at;
+};
+
+struct Record2
+{
+    int64_t id;
+    std::string name;
+    Point2 at;
+    std::vector<std::string> tags;
+    double score = 0.5;
+};
+
+// pmr containers are rebuilt on the memory resource given to unmarshal
+
+struct Note
+{
+    int32_t id;
+    std::pmr::string text;
+    std::pmr::vector<std::pmr::string> tags;
+    std::pmr::map<int32_t, std::pmr::string> refs;
+};
+
+// orders sharing one instrument and a cyclic list, restored as a graph
+
+struct Instrument
+{
+    int32_t id;
+    std::string symbol;
+};
+
+struct Order
+{
+    int64_t id;
+    std::shared_ptr<Instrument> instrument;
+};
+
+struct Node
+{
+    int32_t value;
+    Node* next;
+};
+
+// successive snapshots of a book, sent as the members that changed
+
+struct Book
+{
+    int64_t seq;
+    Tick last;
+    std::string venue;
+    std::vector<double> bids;
+    std::map<int32_t, std::string> notes;
+    Record rec;
+};
+
+struct Leg
+{
+    int32_t ratio;
+    Instrument* instrument;
+};
+
+// a routed message, of which a router reads only a couple of members
+
+struct Route
+{
+    int32_t id;
+    std::string from;
+    std::string to;
+    std::vector<int32_t> hops;
+    Tick tick;
+    std::map<int32_t, std::string> headers;
+    double weight;
+};
+
+// a message whose body is one of several types, members of type std::variant and std::optional are reflected like any other
+
+using Body = std::variant<int32_t, std::string, Tick, Record>;
+
+struct Envelope
+{
+    int64_t id;
+    Body body;
+    std::vector<Body> bodies;
+    std::optional<double> limit;
+};
+
 // smp can reflect, marshal and unmarshal fundamental types, UDTS and all STL containers
 // see line 534
 
@@ -607,5 +747,567 @@ int main(int argc, char* argv[])
 
     delete [] buff;
 
+    // padding free aggregates of fundamental types are marshaled as one block of a compile time known size
+
+    static_assert(!smp::is_bitwise_serializable_v<Y>);
+    static_assert(smp::fixed_size_bytes_v<Tick> == sizeof(Tick));
+
+    Tick tick { 1700000000, 101.25, 300, 1 };
+    std::string tstr = smp::marshal(tick);
+
+    assert(tstr.size() == sizeof(Tick));
+    assert(smp::size_bytes(tick) == sizeof(Tick));
+
+    Tick tick2 = smp::unmarshal<Tick>(tstr);
+
+    assert(tick2.ts == tick.ts);
+    assert(tick2.price == tick.price);
+
+    assert(tick2.qty == tick.qty);
+    assert(tick2.side == tick.side);
+
+    std::cout << "tick " << tick2.ts << " " << tick2.price << std::endl;
+
+    // runs of adjacent fixed size members are coalesced, the encoding is the same as field by field
+
+    Quote quote { 99, 101, 100.5, "XNAS", 7, 1700000000 };
+    std::string qstr = smp::marshal(quote);
+
+    assert(qstr == smp::marshal(smp::tie_fuple(quote)));
+    assert(qstr.size() == smp::size_bytes(quote));
+
+    Quote quote2 = smp::unmarshal<Quote>(qstr);
+
+    assert(quote2.bid == quote.bid && quote2.ask == quote.ask);
+    assert(quote2.price == quote.price && quote2.venue == quote.venue);
+
+    assert(quote2.seq == quote.seq && quote2.ts == quote.ts);
+
+    // unmarshal views that point into the source buffer, no allocation nor copy is made for them
+
+    std::vector<float> fvalues { 0.5f, 1.5f, 2.5f };
+
+    Frame frame { 7, "view", fvalues };
+    std::string fstr = smp::marshal(frame);
+
+    auto fview = smp::make_fuple(7, std::string("view"), fvalues);
+    assert(fstr == smp::marshal(fview));
+
+    Frame frame2 = smp::unmarshal<Frame>(fstr);
+
+    assert(frame2.id == 7 && frame2.name == "view");
+    assert(std::ranges::equal(frame2.values, fvalues));
+
+    assert(frame2.name.data() >= fstr.data() && frame2.name.data() < fstr.data() + fstr.size());
+
+    std::cout << "frame " << frame2.id << " " << frame2.name << " " << frame2.values.size() << std::endl;
+
+    // elements that are not where their alignment wants them are refused instead of viewed
+
+    std::string shifted = " " + fstr;
+    bool refused = 0;
+
+    try
+    {
+        smp::unmarshal<Frame>(std::string_view(shifted).substr(1));
+    }
+    catch (const std::invalid_argument&)
+    {
+        refused = 1;
+    }
+
+    assert(refused);
+    std::cout << "misaligned frame refused " << refused << std::endl;
+
+    // a span views elements written as their raw bytes under any policy, one too short for its length is refused
+
+    constexpr smp::policy signs { .zigzag = 1 };
+
+    std::string zstr = smp::marshal<signs>(smp::make_fuple(fvalues, int64_t(-3)));
+    auto zview = smp::unmarshal<signs, smp::fuple<std::span<const float>, int64_t>>(zstr);
+
+    assert(std::ranges::equal(smp::get<0>(zview), fvalues) && smp::get<1>(zview) == -3);
+    assert((std::ranges::equal(smp::unmarshal<smp::portable, Frame>(smp::marshal<smp::portable>(frame)).values, fvalues)));
+
+    static_assert(smp::viewable<signs, std::vector<float>>() && !smp::viewable<signs, std::vector<int64_t>>());
+    static_assert(!smp::viewable<smp::policy{ .columnar = 1 }, std::vector<Tick>>());
+
+    size_t cut = 0;
+
+    try
+    {
+        smp::unmarshal<Frame>(std::string_view(fstr).substr(0, fstr.size() - sizeof(float)));
+    }
+    catch (const std::out_of_range&)
+    {
+        cut = 1;
+    }
+
+    assert(cut);
+    std::cout << "zigzag view " << smp::get<0>(zview).size() << " values, short frame refused " << cut << std::endl;
+
+    // map owning members of a structure to their views
+
+    static_assert(std::is_same_v<smp::view_t<X>, smp::fuple<float, std::string_view>>);
+    static_assert(std::is_same_v<smp::view_t<Y>, smp::fuple<int, double, char, smp::fuple<float, std::string_view>>>);
+
+    static_assert(std::is_same_v<smp::view_t<std::vector<Tick>>, std::span<const Tick>>);
+
+    auto yview = smp::unmarshal<smp::view_t<Y>>(ys);
+
+    assert(smp::get<0>(yview) == y.i);
+    assert(smp::get<1>(smp::get<3>(yview)) == y.x.s);
+
+    std::cout << "yview " << smp::get<0>(yview) << " " << smp::get<1>(smp::get<3>(yview)) << std::endl;
+
+    // compact encoding, lengths as varints and optionally integers as zigzag varints
+
+    constexpr smp::policy zigzag { .varint = 1, .zigzag = 1 };
+
+    std::string cz = smp::marshal<smp::compact>(z1);
+    std::string zz = smp::marshal<zigzag>(z1);
+
+    assert(cz.size() == smp::size_bytes<smp::compact>(z1));
+    assert(zz.size() == smp::size_bytes<zigzag>(z1));
+
+    assert(zz.size() < cz.size() && cz.size() < zstr1.size());
+
+    auto z5 = smp::unmarshal<smp::compact, Z>(cz);
+    auto z6 = smp::unmarshal<zigzag, Z>(zz);
+
+    assert(smp::marshal(z5) == smp::marshal(z2));
+    assert(smp::marshal(z6) == smp::marshal(z2));
+
+    auto ints = smp::make_fuple(int64_t(-1), int32_t(300), uint16_t(65535), std::vector<int64_t>{ -64, 63, 1ll << 40 });
+    auto istr = smp::marshal<zigzag>(ints);
+
+    assert(istr.size() == 1 + 2 + 3 + 1 + 1 + 1 + 6);
+    assert((smp::unmarshal<zigzag, decltype(ints)>(istr) == ints));
+
+    // a varint of more than 64 bits is refused rather than shifted out of range
+
+    size_t overlong = 0;
+
+    for (std::string v : { std::string(10, char(0x80)) + '\1', std::string(9, char(0xff)) + '\2' })
+    {
+         try
+         {
+             smp::unmarshal<zigzag, uint64_t>(v);
+         }
+         catch (const std::invalid_argument&)
+         {
+             ++overlong;
+         }
+    }
+
+    assert(overlong == 2);
+    assert((smp::unmarshal<zigzag, uint64_t>(std::string(9, char(0xff)) + '\1') == uint64_t(-1)));
+
+    std::cout << "overlong varints refused " << overlong << std::endl;
+
+    // contiguous ranges of trivially copyable elements are marshaled and unmarshaled in bulk
+
+    static_assert(smp::is_bitwise_serializable_v<Tick>);
+    static_assert(!smp::is_bitwise_serializable_v<X>);
+
+    std::vector<float> floats { 1.5f, 2.5f, 3.5f };
+    std::array<double, 3> doubles { 4.25, 5.25, 6.25 };
+    std::vector<Tick> ticks { { 1, 10.5, 100, 1 }, { 2, 11.5, 200, -1 } };
+
+    auto bulk = smp::make_fuple(floats, doubles, ticks);
+    auto bstr = smp::marshal(bulk);
+
+    assert(bstr.size() == smp::size_bytes(bulk));
+    assert(bstr.size() == 3 * sizeof(size_t) + 3 * sizeof(float) + 3 * sizeof(double) + 2 * sizeof(Tick));
+
+    auto bulk2 = smp::unmarshal<decltype(bulk)>(bstr);
+
+    assert(smp::get<0>(bulk2) == floats);
+    assert(smp::get<1>(bulk2) == doubles);
+
+    assert(smp::get<2>(bulk2).size() == 2);
+    assert(smp::get<2>(bulk2)[1].ts == 2 && smp::get<2>(bulk2)[1].side == -1);
+
+    // an explicit byte order, scalars and lengths are byte swapped on hosts of the other order
+
+    constexpr smp::policy big { .order = std::endian::big };
+    constexpr smp::policy little { .order = std::endian::little };
+
+    auto word = smp::make_fuple(uint32_t(0x01020304));
+
+    assert(smp::marshal<big>(word) == std::string("\x01\x02\x03\x04", 4));
+    assert(smp::marshal<little>(word) == std::string("\x04\x03\x02\x01", 4));
+
+    std::cout << "word " << std::hex << smp::get<0>(word) << std::dec << std::endl;
+
+    auto bbulk = smp::marshal<big>(bulk);
+    auto lbulk = smp::marshal<little>(bulk);
+
+    assert(bbulk.size() == smp::size_bytes<big>(bulk) && bbulk.size() == lbulk.size());
+    assert(smp::marshal(smp::unmarshal<big, decltype(bulk)>(bbulk)) == bstr);
+    assert(smp::marshal(smp::unmarshal<little, decltype(bulk)>(lbulk)) == bstr);
+
+    auto bulk3 = smp::unmarshal<big, decltype(bulk)>(bbulk);
+
+    assert(smp::get<0>(bulk3) == floats);
+    assert(smp::get<1>(bulk3) == doubles);
+    assert(smp::get<2>(bulk3)[0].price == 10.5 && smp::get<2>(bulk3)[1].qty == 200);
+
+    std::string bz = smp::marshal<big>(z1);
+    std::string pz = smp::marshal<smp::portable>(z1);
+
+    assert(bz.size() == pz.size() && bz.size() == smp::size_bytes<big>(z1));
+
+    auto z7 = smp::unmarshal<big, Z>(bz);
+    auto z8 = smp::unmarshal<smp::portable, Z>(pz);
+
+    assert(smp::marshal(z7) == smp::marshal(z2));
+    assert(smp::marshal(z8) == smp::marshal(z2));
+
+    // tagged encoding, older readers skip unknown fields and newer readers default missing ones
+
+    constexpr smp::policy tagged { .tagged = 1 };
+    constexpr smp::policy ctagged { .varint = 1, .tagged = 1 };
+
+    Record rec { 7, "old", { 1, 2 } };
+    Record2 rec2 { 8, "new", { 3, 4, 5 }, { "a", "bc" }, 2.5 };
+
+    std::string rstr = smp::marshal<tagged>(rec);
+    std::string rstr2 = smp::marshal<tagged>(rec2);
+
+    assert(rstr.size() == smp::size_bytes<tagged>(rec));
+    assert(rstr2.size() == smp::size_bytes<tagged>(rec2));
+
+    auto up = smp::unmarshal<tagged, Record2>(rstr);
+
+    assert(up.id == 7 && up.name == "old");
+    assert(up.at.x == 1 && up.at.y == 2 && up.at.z == -1);
+    assert(up.tags.empty() && up.score == 0.5);
+
+    auto down = smp::unmarshal<tagged, Record>(rstr2);
+
+    assert(down.id == 8 && down.name == "new");
+    assert(down.at.x == 3 && down.at.y == 4);
+
+    auto same = smp::unmarshal<ctagged, Record2>(smp::marshal<ctagged>(rec2));
+
+    assert(same.at.z == 5 && same.tags == rec2.tags && same.score == 2.5);
+    assert(smp::size_bytes<ctagged>(rec2) < smp::size_bytes<tagged>(rec2));
+
+    // columnar encoding, a range of structs is written as one contiguous column per member
+
+    constexpr smp::policy columnar { .columnar = 1 };
+
+    std::vector<Tick> tape { { 1, 10.5, 100, 1 }, { 2, 11.5, 200, -1 }, { 3, 12.5, 300, 1 } };
+    std::string cstr = smp::marshal<columnar>(tape);
+
+    assert(cstr.size() == smp::size_bytes<columnar>(tape));
+    assert(cstr.size() == sizeof(size_t) + tape.size() * (sizeof(int64_t) + sizeof(double) + 2 * sizeof(int32_t)));
+
+    int64_t col[3];
+    std::memcpy(col, cstr.data() + sizeof(size_t), sizeof(col));
+
+    assert(col[0] == 1 && col[1] == 2 && col[2] == 3);
+
+    auto tape2 = smp::unmarshal<columnar, std::vector<Tick>>(cstr);
+
+    assert(smp::marshal(tape2) == smp::marshal(tape));
+
+    std::list<Quote> quotes { { 1, 2, 1.5, "lse", 10, 20 }, { 3, 4, 3.5, "nyse", 30, 40 } };
+    auto quotes2 = smp::unmarshal<columnar, std::list<Quote>>(smp::marshal<columnar>(quotes));
+
+    assert(smp::marshal(quotes2) == smp::marshal(quotes));
+
+    // unmarshal into a caller supplied memory resource
+
+    Note note { 9, "a note long enough to leave the small string buffer", { "first tag of the note", "second tag of the note" },
+                { { 1, "a reference long enough to allocate" } } };
+
+    std::string nstr = smp::marshal(note);
+
+    alignas(std::max_align_t) std::byte arena[4096];
+    std::pmr::monotonic_buffer_resource mr(arena, sizeof(arena), std::pmr::null_memory_resource());
+
+    auto note2 = smp::unmarshal<Note>(nstr, &mr);
+
+    assert(smp::marshal(note2) == nstr);
+
+    assert(note2.text.get_allocator().resource() == &mr);
+    assert(note2.tags[1].get_allocator().resource() == &mr);
+    assert(note2.refs.at(1).get_allocator().resource() == &mr);
+
+    // only the pointees are placed in the arena, the std::string inside X still comes from the heap and is never freed
+    // for the raw pointer, whose destructor doesn't run, a pointee that lives wholly in the arena has pmr members like Note
+
+    auto xp = smp::make_fuple(&x, std::make_shared<X>(x));
+    auto xp2 = smp::unmarshal<decltype(xp)>(smp::marshal(xp), &mr);
+
+    assert(smp::get<0>(xp2)->s == x.s && smp::get<1>(xp2)->s == x.s);
+    assert(reinterpret_cast<std::byte*>(smp::get<0>(xp2)) >= arena && reinterpret_cast<std::byte*>(smp::get<0>(xp2)) < arena + sizeof(arena));
+
+    // graph encoding, shared pointees are stored once, nulls are explicit and cycles terminate
+
+    constexpr smp::policy graph { .graph = 1 };
+
+    auto es = std::make_shared<Instrument>(1, "ES a long enough symbol");
+    std::vector<Order> orders;
+
+    for (int64_t i = 0; i != 1000; ++i)
+         orders.emplace_back(i, i % 100 ? es : nullptr);
+
+    std::string gstr = smp::marshal<graph>(orders);
+
+    assert(gstr.size() == smp::size_bytes<graph>(orders));
+    assert(gstr.size() * 2 < smp::size_bytes(es) * 990);
+
+    auto orders2 = smp::unmarshal<graph, std::vector<Order>>(gstr);
+
+    assert(orders2.size() == 1000);
+    assert(orders2[0].instrument == nullptr && orders2[1].instrument != nullptr);
+
+    assert(orders2[1].instrument == orders2[999].instrument);
+    assert(orders2[1].instrument.use_count() == 990 && orders2[1].instrument->symbol == es->symbol);
+
+    Node n1 { 1, nullptr };
+    Node n2 { 2, &n1 };
+
+    n1.next = &n2;
+
+    auto ring = smp::unmarshal<graph, Node>(smp::marshal<graph>(n1));
+
+    assert(ring.value == 1 && ring.next->value == 2);
+    assert(ring.next->next->value == 1 && ring.next->next->next == ring.next);
+
+    delete ring.next->next;
+    delete ring.next;
+
+    auto tg = smp::unmarshal<smp::policy{ .tagged = 1, .graph = 1 }, std::vector<Order>>(smp::marshal<smp::policy{ .tagged = 1, .graph = 1 }>(orders));
+
+    assert(tg[1].instrument == tg[2].instrument && tg[2].instrument->symbol == es->symbol);
+
+    // tagged fields with varint lengths are sized on the ids handed out so far, those ids are taken back afterwards
+
+    constexpr smp::policy vtg { .varint = 1, .tagged = 1, .graph = 1 };
+    std::string vtgs = smp::marshal<vtg>(orders);
+
+    assert(vtgs.size() == smp::size_bytes<vtg>(orders));
+    assert((smp::unmarshal<vtg, std::vector<Order>>(vtgs)[100].instrument == nullptr));
+
+    // a pointee reached through a raw pointer before a shared_ptr would come back with no owner, so it is refused
+
+    auto shared = std::make_shared<Instrument>(2, "NQ");
+    auto mixed = smp::make_fuple(shared.get(), shared);
+
+    bool refused_mix = 0;
+
+    try
+    {
+        smp::marshal<graph>(mixed);
+    }
+    catch (const std::invalid_argument&)
+    {
+        refused_mix = 1;
+    }
+
+    assert(refused_mix);
+    std::cout << "raw before shared refused " << refused_mix << std::endl;
+
+    // forged ids are refused on the way back in too, one no pointee was decoded for and one that would share a raw pointee
+
+    std::string forged = smp::marshal<graph>(std::vector<Order>{ { 1, nullptr } });
+    forged[2 * sizeof(size_t)] = 5;
+
+    Instrument raw { 3, "ES" };
+    std::string aliased = smp::marshal<graph>(smp::make_fuple(&raw, std::make_shared<Instrument>(4, "NQ")));
+
+    aliased[sizeof(size_t) + sizeof(int32_t) + sizeof(size_t) + 2] = 1;
+
+    size_t refused_ids = 0;
+
+    try
+    {
+        smp::unmarshal<graph, std::vector<Order>>(forged);
+    }
+    catch (const std::invalid_argument&)
+    {
+        ++refused_ids;
+    }
+
+    try
+    {
+        smp::unmarshal<graph, smp::fuple<Instrument*, std::shared_ptr<Instrument>>>(aliased);
+    }
+    catch (const std::invalid_argument&)
+    {
+        ++refused_ids;
+    }
+
+    assert(refused_ids == 2);
+    std::cout << "forged ids refused " << refused_ids << std::endl;
+
+    // std::variant as the index of the active alternative followed by it
+
+    Envelope envelope { 42, rec, { 7, std::string("text"), Tick{ 1, 10.5, 100, 1 } }, 99.5 };
+    std::string vstr = smp::marshal(envelope);
+
+    assert(vstr.size() == smp::size_bytes(envelope));
+    assert(smp::size_bytes(Body(int32_t(7))) == sizeof(size_t) + sizeof(int32_t));
+
+    static_assert(smp::arity_v<Envelope> == 4);
+    static_assert(std::is_same_v<smp::type_t<1, Envelope>, Body>);
+
+    auto envelope2 = smp::unmarshal<Envelope>(vstr);
+
+    assert(envelope2.body.index() == 3 && std::get<3>(envelope2.body).name == "old");
+    assert(envelope2.bodies.size() == 3 && envelope2.limit == 99.5);
+
+    assert(std::get<0>(envelope2.bodies[0]) == 7);
+    assert(std::get<1>(envelope2.bodies[1]) == "text");
+    assert(std::get<2>(envelope2.bodies[2]).price == 10.5);
+
+    envelope.limit.reset();
+
+    auto cvar = smp::unmarshal<smp::compact, Envelope>(smp::marshal<smp::compact>(envelope));
+    assert(std::get<1>(cvar.bodies[1]) == "text" && !cvar.limit);
+
+    // an index past the alternatives is refused, the bytes after it can't be told apart
+
+    std::string bvar = smp::marshal(Body(int32_t(7)));
+    bvar[0] = 9;
+
+    bool unknown = 0;
+
+    try
+    {
+        smp::unmarshal<Body>(bvar);
+    }
+    catch (const std::invalid_argument&)
+    {
+        unknown = 1;
+    }
+
+    assert(unknown);
+    std::cout << "unknown alternative refused " << unknown << std::endl;
+
+    // a delta carries a bitmap of the changed members and their values, nested aggregates carry deltas of their own
+
+    Book b0 { 1, { 100, 10.5, 5, 1 }, "XNYS", std::vector<double>(1000, 99.5), { { 1, "open" } }, { 7, "book", { 1, 2 } } };
+    Book b1 = b0;
+
+    assert(smp::marshal_delta(b0, b1) == std::string(1, 0));
+
+    b1.seq = 2;
+    b1.last.price = 10.75;
+    b1.notes.erase(1);
+    b1.notes[2] = "halt";
+    b1.rec.at.y = 3;
+
+    std::string dstr = smp::marshal_delta(b0, b1);
+
+    assert(dstr.size() < 64 && dstr.size() * 100 < smp::size_bytes(b1));
+
+    Book b2 = b0;
+    smp::apply_delta(b2, dstr);
+
+    assert(smp::marshal(b2) == smp::marshal(b1));
+    assert(b2.notes.size() == 1 && b2.notes[2] == "halt" && b2.rec.at.x == 1);
+
+    b1.bids[500] = 100.25;
+    b1.venue.clear();
+
+    smp::apply_delta(b2, smp::marshal_delta(b0, b1));
+    assert(smp::marshal(b2) == smp::marshal(b1));
+
+    Instrument i0 { 1, "ESZ2" };
+    Instrument i1 { 1, "ESH3" };
+
+    Leg l0 { 1, &i0 };
+    Leg l1 { 1, &i1 };
+
+    smp::apply_delta(l0, smp::marshal_delta(l0, l1));
+    assert(l0.instrument == &i0 && i0.symbol == "ESH3");
+
+    // a table leads with the end offset of every member, so one member is read without decoding the others
+
+    Route route { 9, "gateway", "matcher", { 4, 8, 15 }, { 100, 10.5, 5, 1 }, { { 1, "urgent" } }, 0.75 };
+    std::string table = smp::marshal_table(route);
+
+    assert(table.size() >= smp::table_header<Route> + smp::size_bytes(route));
+    assert(table.size() < smp::table_header<Route> + smp::size_bytes(route) + smp::table_align * smp::tuple_size_v<Route>);
+
+    std::string_view to = smp::peek<2, Route>(table);
+    assert(to == "matcher" && to.data() > table.data() && to.data() < table.data() + table.size());
+
+    std::cout << "peek " << to << std::endl;
+
+    auto hops = smp::peek<3, Route>(table);
+    static_assert(std::is_same_v<decltype(hops), std::span<const int32_t>>);
+
+    assert(hops.size() == 3 && hops[2] == 15);
+    assert((smp::peek<4, Route>(table).price == 10.5 && smp::peek<6, Route>(table) == 0.75));
+
+    assert((smp::peek<std::map<int32_t, std::string>, Route>(table).at(1) == "urgent"));
+    assert(smp::marshal(smp::unmarshal_table<Route>(table)) == smp::marshal(route));
+
+    std::string ptable = smp::marshal_table<smp::portable>(route);
+
+    assert((smp::peek<smp::portable, 0, Route>(ptable) == 9));
+    assert((smp::peek<smp::portable, double, Route>(ptable) == 0.75));
+
+    // varint lengths leave members unaligned, so strings and vectors are decoded rather than viewed
+
+    std::string ctable = smp::marshal_table<smp::compact>(route);
+    auto chops = smp::peek<smp::compact, 3, Route>(ctable);
+
+    assert(ctable.size() < table.size() && chops == route.hops);
+
+    // nor are elements that aren't written as their raw bytes, such as zigzag varint integers
+
+    auto zhops = smp::peek<smp::policy{ .zigzag = 1 }, 3, Route>(smp::marshal_table<smp::policy{ .zigzag = 1 }>(route));
+    static_assert(std::is_same_v<decltype(zhops), std::vector<int32_t>>);
+
+    assert(zhops == route.hops);
+
+    // a table written to a sink is zero padded the same way
+
+    char tbuf[512];
+    smp::fixed_sink tsink(tbuf, sizeof(tbuf));
+
+    smp::marshal_table(tsink, route);
+    assert(std::string_view(tbuf, tsink.length()) == table);
+
+    // a lazy proxy decodes a member the first time it is asked for and keeps it
+
+    smp::lazy<Route> lz(table);
+
+    assert(smp::get<Tick>(lz).ts == 100 && lz.cached<4>());
+    assert(!lz.cached<1>() && !lz.cached<3>() && !lz.cached<5>());
+
+    auto& from = smp::get<1>(lz);
+
+    assert(from == "gateway" && &smp::get<std::string>(lz) == &from);
+    assert(smp::get<3>(lz) == route.hops && !lz.cached<5>());
+
+    const auto& clz = lz;
+    assert(smp::get<6>(clz) == 0.75);
+
+    assert(smp::marshal(lz.value()) == smp::marshal(route) && lz.cached<5>());
+
+    std::cout << "lazy " << from << " " << smp::get<6>(clz) << std::endl;
+
+    smp::lazy<Route, smp::compact> clazy(ctable);
+    assert(smp::get<2>(clazy) == "matcher" && !clazy.cached<0>());
+
+    // values and containers of constant encoded size are sized without a traversal
+
+    static_assert(smp::static_size_bytes_v<Tick> == sizeof(Tick));
+    static_assert(smp::static_size_bytes_v<Record> == 0 && smp::static_size_bytes_v<Point2> == 3 * sizeof(int32_t));
+
+    static_assert(smp::static_size_bytes_v<std::array<Point, 4>> == sizeof(size_t) + 4 * sizeof(Point));
+    static_assert(smp::static_size_bytes_v<Point, smp::policy{ .zigzag = 1 }> == 0);
+
+    std::map<int32_t, Tick> tmap { { 1, Tick{} }, { 2, Tick{} } };
+    assert(smp::size_bytes(tmap) == smp::marshal(tmap).size());
+
     return 0;
 }
@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+// g++ -I include -m64 -std=c++23 -s -Wall -O3 -o /tmp/sink example/sink.cpp
+
+#include <list>
+#include <ranges>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <sstream>
+#include <iostream>
+#include <forward_list>
+#include <reflect.hpp>
+
+struct X
+{
+    float f;
+    std::string s;
+};
+
+struct Y
+{
+    int i;
+    double d;
+    char c;
+    X x;
+    std::vector<double> v;
+};
+
+int main(int argc, char* argv[])
+{
+    Y y { 2022, 12.05, '*', { 18.47f, "stateful" } };
+    y.v.assign(100000, 3.14);
+
+    std::string ys = smp::marshal(y);
+    size_t size = smp::size_bytes(y);
+
+    assert(ys.size() == size);
+
+    // marshal into a bounded buffer, overflow is detected instead of writing past its end
+
+    std::vector<char> buff(size);
+    smp::fixed_sink fs(buff.data(), buff.size());
+
+    smp::marshal(fs, y);
+
+    assert(!fs.overflow());
+    assert(fs.length() == size);
+
+    assert(std::string_view(buff.data(), size) == ys);
+
+    smp::fixed_sink small(buff.data(), size / 2);
+    smp::marshal(small, y);
+
+    assert(small.overflow());
+    assert(smp::marshal(buff.data(), size - 1, y).empty());
+
+    // a growable std::vector<std::byte> is sized once like std::string
+
+    std::vector<std::byte> bytes;
+    smp::marshal(bytes, y);
+
+    assert(bytes.size() == size);
+    assert(std::memcmp(bytes.data(), ys.data(), size) == 0);
+
+    // stream the encoding in chunks to a flush callback without materialising it
+
+    size_t chunks = 0;
+    std::string streamed;
+
+    smp::chunk_sink cs([&](const char* data, size_t size)
+    {
+        ++chunks;
+        streamed.append(data, size);
+    }, 4096);
+
+    smp::marshal(cs, y);
+    cs.flush();
+
+    assert(streamed == ys);
+    assert(cs.length() == size);
+
+    assert(chunks > 1);
+    std::cout << size << " bytes streamed in " << chunks << " chunks" << std::endl;
+
+    auto y2 = smp::unmarshal<Y>(streamed);
+
+    assert(y2.i == y.i);
+    assert(y2.x.s == y.x.s);
+
+    assert(y2.v == y.v);
+
+    // byte swapped ranges reach a sink through a small staging buffer
+
+    constexpr smp::policy big { .order = std::endian::big };
+    std::string bs = smp::marshal<big>(y);
+
+    smp::fixed_sink bfs(buff.data(), buff.size());
+    smp::marshal<big>(bfs, y);
+
+    assert(!bfs.overflow());
+    assert(std::string_view(buff.data(), bfs.length()) == bs);
+
+    assert((smp::unmarshal<big, Y>(bs).v == y.v));
+
+    // ranges without size() are encoded in one pass, their length is patched in after their elements
+
+    std::vector<int> ints { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+    auto even = ints | std::views::filter([](int i){ return i % 2 == 0; });
+    auto names = ints | std::views::filter([](int i){ return i > 7; }) | std::views::transform([](int i){ return std::to_string(i); });
+
+    std::string es = smp::marshal(even);
+    std::string ns = smp::marshal(names);
+
+    assert(es == smp::marshal(std::vector<int>{ 2, 4, 6, 8, 10 }) && es.size() == smp::size_bytes(even));
+    assert(ns == smp::marshal(std::vector<std::string>{ "8", "9", "10" }));
+
+    std::cout << es.size() << " + " << ns.size() << " bytes from unsized ranges" << std::endl;
+
+    std::forward_list<X> xs { { 1.5f, "one" }, { 2.5f, "two" } };
+    std::list<X> xl(xs.begin(), xs.end());
+
+    assert(smp::marshal(xs) == smp::marshal(xl));
+
+    smp::fixed_sink efs(buff.data(), buff.size());
+    smp::marshal(efs, even);
+
+    assert(std::string_view(buff.data(), efs.length()) == es);
+
+    // varint lengths can't be patched in place, nor can a sink that has already flushed, so the range is walked twice
+
+    assert(smp::marshal<smp::compact>(even) == smp::marshal<smp::compact>(std::vector<int>{ 2, 4, 6, 8, 10 }));
+
+    std::string ecs;
+    smp::chunk_sink ecc([&](const char* data, size_t size){ ecs.append(data, size); }, 4);
+
+    smp::marshal(ecc, even);
+    ecc.flush();
+
+    assert(ecs == es);
+
+    // a single pass range is encoded straight into a growable buffer, or into a scratch buffer behind its varint length
+
+    std::istringstream in("5 4 3 2 1");
+    auto once = std::views::istream<int>(in);
+
+    std::string is = smp::marshal(once);
+    assert(is == smp::marshal(std::vector<int>{ 5, 4, 3, 2, 1 }));
+
+    std::istringstream cin("5 4 3 2 1");
+    auto conce = std::views::istream<int>(cin);
+
+    std::string os;
+    smp::marshal<smp::compact>(os, conce);
+
+    assert(os == smp::marshal<smp::compact>(std::vector<int>{ 5, 4, 3, 2, 1 }));
+
+    std::istringstream bin("7 8 9");
+    auto bonce = std::views::istream<int>(bin);
+
+    std::vector<std::byte> obytes;
+    smp::marshal(obytes, bonce);
+
+    std::string ob = smp::marshal(std::vector<int>{ 7, 8, 9 });
+    assert(obytes.size() == ob.size() && std::memcmp(obytes.data(), ob.data(), ob.size()) == 0);
+
+    return 0;
+}
@@ -44,6 +44,14 @@ int main(int argc, char* argv[])
     static_assert(std::is_same_v<smp::fuple_element_t<0, type>, int>);
     static_assert(std::is_same_v<smp::fuple_element_t<2, type>, char>);
 
+    // get the offset of a member at compile time
+
+    static_assert(v.position<1>() == 8);
+    static_assert(v.position<2>() == 16);
+
+    static_assert(v.position<3>() == 24);
+    assert(v.offset<3>() == 24);
+
     // extract the nth member by reference 
 
     v.get<0>(y) = 2023;
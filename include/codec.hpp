@@ -0,0 +1,520 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+#ifndef CODEC_HPP
+#define CODEC_HPP
+
+#include <bit>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <sink.hpp>
+
+namespace smp
+{
+    // a codec packs one block of at most 64KiB at a time
+    // encode writes at most bound(n) bytes, decode returns the unpacked size or size_t(-1) on malformed input
+
+    // runs of three or more equal bytes as a count and the byte, anything else as counted literals
+
+    struct rle
+    {
+        static constexpr size_t bound(size_t n) noexcept
+        {
+            return n + (n + 127) / 128;
+        }
+
+        static size_t encode(const char* src, size_t n, char* dst) noexcept
+        {
+            auto out = dst;
+            size_t i = 0;
+
+            size_t anchor = 0;
+
+            auto literals = [&](size_t e)
+            {
+                while (anchor != e)
+                {
+                    size_t k = std::min<size_t>(e - anchor, 128);
+
+                    *out++ = char(k - 1);
+                    std::memcpy(out, src + anchor, k);
+
+                    out += k;
+                    anchor += k;
+                }
+            };
+
+            while (i != n)
+            {
+                size_t j = i + 1;
+
+                while (j != n && j - i != 130 && src[j] == src[i])
+                       ++j;
+
+                if (j - i >= 3)
+                {
+                    literals(i);
+
+                    *out++ = char(128 + j - i - 3);
+                    *out++ = src[i];
+
+                    anchor = j;
+                }
+
+                i = j - i >= 3 ? j : i + 1;
+            }
+
+            literals(n);
+
+            return out - dst;
+        }
+
+        static size_t decode(const char* src, size_t n, char* dst, size_t size) noexcept
+        {
+            auto end = src + n;
+            auto out = dst;
+
+            while (src != end)
+            {
+                auto c = uint8_t(*src++);
+                size_t k = c < 128 ? c + 1 : c - 128 + 3;
+
+                if (k > size - (out - dst) || src + (c < 128 ? k : 1) > end)
+                    return size_t(-1);
+
+                if (c < 128)
+                {
+                    std::memcpy(out, src, k);
+                    src += k;
+                }
+                else
+                    std::memset(out, *src++, k);
+
+                out += k;
+            }
+
+            return out - dst;
+        }
+    };
+
+    // LZ77 with a single entry hash table of 4 byte sequences, sequences are laid out as
+    // a token of literal length and match length nibbles, the literals, a 2 byte offset and the match length extension
+    // the last sequence carries literals only
+
+    struct lz
+    {
+        static constexpr size_t min_match = 4;
+        static constexpr size_t hash_bits = 12;
+
+        static constexpr size_t bound(size_t n) noexcept
+        {
+            return n + n / 255 + 16;
+        }
+
+        static uint32_t read32(const char* p) noexcept
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+
+            return v;
+        }
+
+        static size_t hash(uint32_t v) noexcept
+        {
+            return (v * 2654435761u) >> (32 - hash_bits);
+        }
+
+        static char* count(char* out, size_t k) noexcept
+        {
+            for (; k >= 255; k -= 255)
+                 *out++ = char(255);
+
+            *out++ = char(k);
+
+            return out;
+        }
+
+        static size_t encode(const char* src, size_t n, char* dst) noexcept
+        {
+            uint32_t table[1 << hash_bits] = {};
+
+            auto out = dst;
+
+            size_t i = 0;
+            size_t anchor = 0;
+
+            auto sequence = [&](size_t e, size_t offset, size_t match)
+            {
+                size_t k = e - anchor;
+                size_t m = match ? match - min_match : 0;
+
+                auto token = out++;
+                *token = char((std::min<size_t>(k, 15) << 4) | std::min<size_t>(m, 15));
+
+                if (k >= 15)
+                    out = count(out, k - 15);
+
+                std::memcpy(out, src + anchor, k);
+                out += k;
+
+                if (match)
+                {
+                    *out++ = char(offset);
+                    *out++ = char(offset >> 8);
+
+                    if (m >= 15)
+                        out = count(out, m - 15);
+                }
+            };
+
+            while (i + min_match <= n)
+            {
+                uint32_t v = read32(src + i);
+                auto& slot = table[hash(v)];
+
+                size_t c = slot;
+                slot = uint32_t(i + 1);
+
+                if (c-- && i - c <= 0xffff && read32(src + c) == v)
+                {
+                    size_t k = min_match;
+
+                    while (i + k != n && src[c + k] == src[i + k])
+                           ++k;
+
+                    sequence(i, i - c, k);
+
+                    i += k;
+                    anchor = i;
+                }
+                else
+                    ++i;
+            }
+
+            sequence(n, 0, 0);
+
+            return out - dst;
+        }
+
+        static size_t decode(const char* src, size_t n, char* dst, size_t size) noexcept
+        {
+            auto end = src + n;
+            auto out = dst;
+
+            auto extend = [&](size_t& k)
+            {
+                for (uint8_t b = 255; b == 255; k += b)
+                {
+                     if (src == end)
+                         return 0;
+
+                     b = uint8_t(*src++);
+                }
+
+                return 1;
+            };
+
+            while (src != end)
+            {
+                auto token = uint8_t(*src++);
+
+                size_t k = token >> 4;
+                size_t m = token & 15;
+
+                if ((k == 15 && !extend(k)) || k > size_t(end - src) || k > size - (out - dst))
+                    return size_t(-1);
+
+                std::memcpy(out, src, k);
+
+                src += k;
+                out += k;
+
+                if (src == end)
+                    break;
+
+                if (end - src < 2)
+                    return size_t(-1);
+
+                size_t offset = uint8_t(src[0]) | uint8_t(src[1]) << 8;
+                src += 2;
+
+                if ((m == 15 && !extend(m)) || !offset || offset > size_t(out - dst) || (m += min_match) > size - (out - dst))
+                    return size_t(-1);
+
+                // an overlapping match repeats its period, so it is copied forward one byte at a time
+                if (offset >= m)
+                    std::memcpy(out, out - offset, m);
+                else
+                {
+                    for (size_t j = 0; j != m; ++j)
+                         out[j] = out[j - offset];
+                }
+
+                out += m;
+            }
+
+            return out - dst;
+        }
+    };
+
+    // blocks are a u32 unpacked size, a u32 packed size and the packed bytes, the sizes in little endian
+    // a block that doesn't shrink is stored as is, with equal sizes
+
+    inline constexpr size_t block_size = 1 << 16;
+    inline constexpr size_t block_header = 2 * sizeof(uint32_t);
+
+    inline void store_le32(char* p, uint32_t v) noexcept
+    {
+        if constexpr(std::endian::native == std::endian::big)
+            v = std::byteswap(v);
+
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+    inline uint32_t load_le32(const char* p) noexcept
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+
+        if constexpr(std::endian::native == std::endian::big)
+            v = std::byteswap(v);
+
+        return v;
+    }
+
+    // a sink that packs what is written to it block by block and hands the blocks to the sink s
+
+    template <typename Codec, sink S>
+    struct compressor
+    {
+        compressor(S& s) : s(s), buff(std::make_unique_for_overwrite<char[]>(block_size)), pack(std::make_unique_for_overwrite<char[]>(block_header + Codec::bound(block_size)))
+        {
+        }
+
+        bool write(const void* p, size_t n)
+        {
+            auto q = static_cast<const char*>(p);
+            total += n;
+
+            while (n)
+            {
+                size_t k = std::min(n, block_size - used);
+                std::memcpy(buff.get() + used, q, k);
+
+                q += k;
+                n -= k;
+
+                if ((used += k) == block_size)
+                    seal();
+            }
+
+            return good;
+        }
+
+        // packs the pending partial block and flushes s if it buffers
+        bool flush()
+        {
+            if (used)
+                seal();
+
+            if constexpr(requires { s.flush(); })
+                s.flush();
+
+            return good;
+        }
+
+        void seal()
+        {
+            auto p = pack.get() + block_header;
+
+            uint32_t raw = used;
+            uint32_t packed = Codec::encode(buff.get(), used, p);
+
+            if (packed >= raw)
+            {
+                std::memcpy(p, buff.get(), raw);
+                packed = raw;
+            }
+
+            store_le32(pack.get(), raw);
+            store_le32(pack.get() + sizeof(raw), packed);
+
+            if constexpr(std::is_same_v<decltype(s.write(p, packed)), bool>)
+                good = s.write(pack.get(), block_header + packed) && good;
+            else
+                s.write(pack.get(), block_header + packed);
+
+            used = 0;
+        }
+
+        // the number of unpacked bytes written so far
+        size_t length() const noexcept
+        {
+            return total;
+        }
+
+        S& s;
+
+        std::unique_ptr<char[]> buff;
+        std::unique_ptr<char[]> pack;
+
+        size_t used = 0;
+        size_t total = 0;
+
+        bool good = 1;
+    };
+
+    // unpacks blocks fed in chunks of any size, every unpacked block is handed to f(const char*, size_t)
+
+    template <typename Codec>
+    struct decompressor
+    {
+        decompressor() : buff(std::make_unique_for_overwrite<char[]>(block_size))
+        {
+        }
+
+        // false once the input is malformed, nothing is handed to f from then on
+        template <typename F>
+        bool feed(const void* data, size_t size, F&& f)
+        {
+            auto p = static_cast<const char*>(data);
+            auto end = p + size;
+
+            while (good && p != end)
+            {
+                size_t left = end - p;
+
+                // a block is unpacked straight from the input when it arrives whole, otherwise it is staged
+                if (stage.empty() && left >= block_header && left >= frame(p))
+                {
+                    if (good)
+                        unpack(p, f);
+
+                    p += frame(p);
+                }
+                else
+                {
+                    size_t need = stage.size() < block_header ? block_header : frame(stage.data());
+                    size_t k = std::min(need - stage.size(), left);
+
+                    stage.append(p, k);
+                    p += k;
+
+                    if (stage.size() >= block_header && stage.size() == frame(stage.data()) && good)
+                    {
+                        unpack(stage.data(), f);
+                        stage.clear();
+                    }
+                }
+            }
+
+            return good;
+        }
+
+        template <typename F>
+        bool feed(std::string_view s, F&& f)
+        {
+            return feed(s.data(), s.size(), std::forward<F>(f));
+        }
+
+        // no partial block is pending
+        bool done() const noexcept
+        {
+            return good && stage.empty();
+        }
+
+        static uint32_t packed(const char* p) noexcept
+        {
+            return load_le32(p + sizeof(uint32_t));
+        }
+
+        // the size of the block starting at p, a packed size no block can have marks the input malformed
+        size_t frame(const char* p) noexcept
+        {
+            size_t n = packed(p);
+
+            if (n > Codec::bound(block_size))
+            {
+                good = 0;
+                n = 0;
+            }
+
+            return block_header + n;
+        }
+
+        template <typename F>
+        void unpack(const char* p, F&& f)
+        {
+            uint32_t raw = load_le32(p);
+            uint32_t n = packed(p);
+            p += block_header;
+
+            if (raw > block_size)
+                good = 0;
+            else if (n == raw)
+                std::invoke(f, p, size_t(raw));
+            else if (Codec::decode(p, n, buff.get(), raw) == raw)
+                std::invoke(f, std::as_const(buff).get(), size_t(raw));
+            else
+                good = 0;
+        }
+
+        std::unique_ptr<char[]> buff;
+        std::string stage;
+
+        bool good = 1;
+    };
+
+    template <typename Codec>
+    std::string compress(std::string_view s)
+    {
+        std::string r;
+
+        struct appender
+        {
+            void write(const void* p, size_t n)
+            {
+                r.append(static_cast<const char*>(p), n);
+            }
+
+            std::string& r;
+        }
+        a{ r };
+
+        compressor<Codec, appender> c(a);
+
+        c.write(s.data(), s.size());
+        c.flush();
+
+        return r;
+    }
+
+    // the unpacked bytes, or an empty string when s is malformed or ends inside a block
+    template <typename Codec>
+    std::string decompress(std::string_view s)
+    {
+        std::string r;
+        decompressor<Codec> d;
+
+        d.feed(s, [&](const char* p, size_t n)
+        {
+            r.append(p, n);
+        });
+
+        return d.done() ? r : std::string();
+    }
+}
+
+#endif
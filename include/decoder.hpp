@@ -0,0 +1,416 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+#ifndef DECODER_HPP
+#define DECODER_HPP
+
+#include <array>
+#include <coroutine>
+#include <reflect.hpp>
+
+namespace smp
+{
+    enum class status
+    {
+        more,
+        done
+    };
+
+    // freed coroutine frames are kept per size for the next coroutine of that size on the same thread
+    // the elements of a container are decoded one after another, each one reusing the frame of the one before
+
+    struct frame_pool
+    {
+        static constexpr size_t grain = 16;
+        static constexpr size_t classes = 256;
+
+        ~frame_pool()
+        {
+            for (void* p : heads)
+            {
+                while (p)
+                       ::operator delete(std::exchange(p, *static_cast<void**>(p)));
+            }
+        }
+
+        void* allocate(size_t n)
+        {
+            size_t c = (n + grain - 1) / grain;
+
+            if (c >= classes)
+                return ::operator new(n);
+
+            if (void* p = heads[c])
+            {
+                heads[c] = *static_cast<void**>(p);
+
+                return p;
+            }
+
+            return ::operator new(c * grain);
+        }
+
+        void deallocate(void* p, size_t n) noexcept
+        {
+            size_t c = (n + grain - 1) / grain;
+
+            if (c >= classes)
+                ::operator delete(p);
+            else
+                *static_cast<void**>(p) = std::exchange(heads[c], p);
+        }
+
+        static frame_pool& local() noexcept
+        {
+            thread_local frame_pool f;
+
+            return f;
+        }
+
+        std::array<void*, classes> heads{};
+    };
+
+    // a coroutine that starts suspended and resumes its awaiter when it completes
+
+    struct task
+    {
+        struct promise_type;
+        using handle_t = std::coroutine_handle<promise_type>;
+
+        struct final_awaiter
+        {
+            bool await_ready() const noexcept
+            {
+                return 0;
+            }
+
+            std::coroutine_handle<> await_suspend(handle_t h) const noexcept
+            {
+                return h.promise().next;
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        struct promise_type
+        {
+            task get_return_object() noexcept
+            {
+                return task(handle_t::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            final_awaiter final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void return_void() const noexcept
+            {
+            }
+
+            void unhandled_exception()
+            {
+                throw;
+            }
+
+            static void* operator new(size_t n)
+            {
+                return frame_pool::local().allocate(n);
+            }
+
+            static void operator delete(void* p, size_t n) noexcept
+            {
+                frame_pool::local().deallocate(p, n);
+            }
+
+            std::coroutine_handle<> next = std::noop_coroutine();
+        };
+
+        explicit task(handle_t h) noexcept : h(h)
+        {
+        }
+
+        task(task&& r) noexcept : h(std::exchange(r.h, {}))
+        {
+        }
+
+        ~task()
+        {
+            if (h)
+                h.destroy();
+        }
+
+        bool await_ready() const noexcept
+        {
+            return 0;
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept
+        {
+            h.promise().next = c;
+
+            return h;
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+
+        handle_t h;
+    };
+
+    // a resumable unmarshal of one T, fed with byte chunks as they arrive
+    // the position in the encoding lives in the suspended coroutine frames, so no input is staged or parsed twice
+    // only the default encoding in the byte order of the host is understood, pointees come from new and containers
+    // are filled through their own allocators, feed throws std::invalid_argument on a variant index past the alternatives
+    // and the decoder is done with from then on
+
+    template <typename T, policy P = policy{}>
+    struct decoder
+    {
+        static_assert(!P.varint && !P.zigzag && !P.tagged && !P.columnar && !P.graph && P.order == std::endian::native,
+                      "decoder reads the default encoding in native byte order only");
+
+        decoder() : root(decode(t))
+        {
+        }
+
+        decoder(decoder&&) = delete;
+
+        struct reader
+        {
+            bool await_ready() noexcept
+            {
+                return d->fill(p, n);
+            }
+
+            void await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                d->pending = this;
+                d->waiter = h;
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+
+            decoder* d;
+
+            char* p;
+            size_t n;
+        };
+
+        status feed(const void* data, size_t size)
+        {
+            head = static_cast<const char*>(data);
+            tail = head + size;
+
+            auto curr = head;
+
+            if (!done())
+            {
+                if (!pending)
+                    root.h.resume();
+                else if (fill(pending->p, pending->n))
+                {
+                    pending = nullptr;
+                    waiter.resume();
+                }
+            }
+
+            used = head - curr;
+
+            return done() ? status::done : status::more;
+        }
+
+        status feed(std::string_view s)
+        {
+            return feed(s.data(), s.size());
+        }
+
+        bool done() const noexcept
+        {
+            return root.h.done();
+        }
+
+        // the number of bytes taken from the last chunk, the rest belongs to whatever follows this object
+        size_t consumed() const noexcept
+        {
+            return used;
+        }
+
+        T& value() noexcept
+        {
+            return t;
+        }
+
+        bool fill(char*& p, size_t& n) noexcept
+        {
+            size_t k = std::min<size_t>(n, tail - head);
+
+            if (k)
+                std::memcpy(p, head, k);
+
+            head += k;
+            p += k;
+
+            return !(n -= k);
+        }
+
+        reader read(void* p, size_t n) noexcept
+        {
+            return reader{ this, static_cast<char*>(p), n };
+        }
+
+        template <typename U>
+        auto visit(U& u)
+        {
+            if constexpr(is_bitwise_serializable_v<U>)
+                return read(std::addressof(u), fixed_size_bytes_v<U>);
+            else
+                return decode(u);
+        }
+
+        template <size_t N, typename U>
+        auto field(U& u)
+        {
+            using R = copy_plan<U>;
+            decltype(auto) m = typename R::V().template get<N>(u);
+
+            if constexpr(R::template joined<N>())
+                return std::suspend_never();
+            else if constexpr(R::template fixed<N>())
+                return read(std::addressof(m), R::template bytes<N>());
+            else
+                return decode(m);
+        }
+
+        template <typename U>
+        task decode(U& u)
+        {
+            if constexpr(is_bitwise_serializable_v<U>)
+                co_await visit(u);
+            else if constexpr(std::is_pointer_v<U> || requires { typename U::weak_type; })
+            {
+                if constexpr(std::is_pointer_v<U>)
+                    u = new std::remove_pointer_t<U>();
+                else
+                    u = std::make_shared<typename U::element_type>();
+
+                co_await visit(*u);
+            }
+            else if constexpr(requires { u.index(); u.valueless_by_exception(); })
+            {
+                size_t i = 0;
+                co_await visit(i);
+
+                if (i >= std::variant_size_v<U>)
+                    throw std::invalid_argument("smp: variant index past its alternatives");
+
+                co_await [&]<size_t... N>(std::index_sequence<N...>) -> task
+                {
+                    (..., (i == N ? co_await visit(u.template emplace<N>()) : void()));
+                }
+                (std::make_index_sequence<std::variant_size_v<U>>());
+            }
+            else if constexpr(requires { u.has_value(); })
+            {
+                bool b = 0;
+                co_await visit(b);
+
+                if (b)
+                {
+                    u = typename U::value_type();
+                    co_await visit(*u);
+                }
+            }
+            else if constexpr(requires { u.begin(); u.end(); })
+            {
+                size_t size = 0;
+                co_await visit(size);
+
+                if constexpr(requires { typename U::key_type; typename U::value_type; })
+                {
+                    if constexpr(requires { u.reserve(size); })
+                        u.reserve(u.size() + size);
+
+                    for (size_t i = 0; i != size; ++i)
+                    {
+                        typename U::key_type key;
+                        co_await visit(key);
+
+                        if constexpr(! requires { typename U::mapped_type; })
+                            smp::insert(u, std::move(key));
+                        else
+                        {
+                            typename U::mapped_type val;
+                            co_await visit(val);
+
+                            smp::insert(u, std::move(key), std::move(val));
+                        }
+                    }
+                }
+                else
+                {
+                    if constexpr(requires { u.resize(0); })
+                        u.resize(size);
+
+                    using V = std::ranges::range_value_t<U>;
+
+                    if constexpr(std::ranges::contiguous_range<U> && std::ranges::sized_range<U> && is_bitwise_serializable_v<V>)
+                        co_await read(std::ranges::data(u), std::ranges::size(u) * sizeof(V));
+                    else
+                    {
+                        for (auto& v : u)
+                             co_await visit(v);
+                    }
+                }
+            }
+            else if constexpr(std::is_aggregate_v<U>)
+            {
+                co_await [&]<size_t... N>(std::index_sequence<N...>) -> task
+                {
+                    (..., co_await field<N>(u));
+                }
+                (std::make_index_sequence<copy_plan<U>::V::size()>());
+            }
+            else
+            {
+                co_await [&]<size_t... N>(std::index_sequence<N...>) -> task
+                {
+                    if constexpr(is_tuple_v<U>)
+                        (..., co_await visit(std::get<N>(u)));
+                    else
+                        (..., co_await visit(smp::get<N>(u)));
+                }
+                (rank<U>());
+            }
+        }
+
+        T t;
+        task root;
+
+        const char* head = nullptr;
+        const char* tail = nullptr;
+
+        size_t used = 0;
+
+        reader* pending = nullptr;
+        std::coroutine_handle<> waiter;
+    };
+}
+
+#endif
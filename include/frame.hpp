@@ -0,0 +1,372 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+#ifndef FRAME_HPP
+#define FRAME_HPP
+
+#include <array>
+#include <optional>
+#include <reflect.hpp>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#   include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#   include <arm_acle.h>
+#endif
+
+namespace smp
+{
+    // CRC32C (Castagnoli) over the reflected polynomial 0x82f63b78, table j maps a byte to its crc j bytes further on
+
+    inline constexpr auto crc32c_table = []
+    {
+        std::array<std::array<uint32_t, 256>, 8> t{};
+
+        for (uint32_t i = 0; i != 256; ++i)
+        {
+            uint32_t c = i;
+
+            for (int k = 0; k != 8; ++k)
+                 c = c >> 1 ^ (c & 1 ? 0x82f63b78 : 0);
+
+            t[0][i] = c;
+        }
+
+        for (size_t j = 1; j != 8; ++j)
+        {
+            for (size_t i = 0; i != 256; ++i)
+                 t[j][i] = t[j - 1][i] >> 8 ^ t[0][t[j - 1][i] & 0xff];
+        }
+
+        return t;
+    }();
+
+    // the crc32c steps below take and return the crc in its inverted form
+
+    inline uint32_t crc32c_slice8(uint32_t crc, const unsigned char* q, size_t n) noexcept
+    {
+        auto& t = crc32c_table;
+
+        for (; n >= 8; n -= 8, q += 8)
+        {
+             uint32_t lo = crc ^ (q[0] | q[1] << 8 | q[2] << 16 | uint32_t(q[3]) << 24);
+             uint32_t hi = q[4] | q[5] << 8 | q[6] << 16 | uint32_t(q[7]) << 24;
+
+             crc = t[7][lo & 0xff] ^ t[6][lo >> 8 & 0xff] ^ t[5][lo >> 16 & 0xff] ^ t[4][lo >> 24] ^
+                   t[3][hi & 0xff] ^ t[2][hi >> 8 & 0xff] ^ t[1][hi >> 16 & 0xff] ^ t[0][hi >> 24];
+        }
+
+        for (; n; --n)
+             crc = crc >> 8 ^ t[0][(crc ^ *q++) & 0xff];
+
+        return crc;
+    }
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    __attribute__((target("sse4.2"))) inline uint32_t crc32c_sse42(uint32_t crc, const unsigned char* q, size_t n) noexcept
+    {
+        uint64_t c = crc;
+
+        for (; n >= 8; n -= 8, q += 8)
+        {
+             uint64_t v;
+             std::memcpy(&v, q, sizeof(v));
+
+             c = _mm_crc32_u64(c, v);
+        }
+
+        crc = uint32_t(c);
+
+        for (; n; --n)
+             crc = _mm_crc32_u8(crc, *q++);
+
+        return crc;
+    }
+#elif defined(__ARM_FEATURE_CRC32)
+    inline uint32_t crc32c_arm(uint32_t crc, const unsigned char* q, size_t n) noexcept
+    {
+        for (; n >= 8; n -= 8, q += 8)
+        {
+             uint64_t v;
+             std::memcpy(&v, q, sizeof(v));
+
+             if constexpr(std::endian::native == std::endian::big)
+                 v = std::byteswap(v);
+
+             crc = __crc32cd(crc, v);
+        }
+
+        for (; n; --n)
+             crc = __crc32cb(crc, *q++);
+
+        return crc;
+    }
+#endif
+
+    // extends the crc of the bytes seen so far with n more bytes at p, the crc of no bytes is 0
+    // the crc32 instruction of SSE4.2 is used when the target is built for it or else the running cpu has it,
+    // the one of ARMv8 when the target is built for it, slicing by 8 otherwise
+
+    inline uint32_t crc32c(uint32_t crc, const void* p, size_t n) noexcept
+    {
+        auto q = static_cast<const unsigned char*>(p);
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#   if defined(__SSE4_2__)
+        return ~crc32c_sse42(~crc, q, n);
+#   else
+        if (__builtin_cpu_supports("sse4.2"))
+            return ~crc32c_sse42(~crc, q, n);
+        else
+            return ~crc32c_slice8(~crc, q, n);
+#   endif
+#elif defined(__ARM_FEATURE_CRC32)
+        return ~crc32c_arm(~crc, q, n);
+#else
+        return ~crc32c_slice8(~crc, q, n);
+#endif
+    }
+
+    // a sink that checksums what is written to it on its way to the sink s
+
+    template <sink S>
+    struct crc_sink
+    {
+        crc_sink(S& s, uint32_t crc = 0) noexcept : s(s), crc(crc)
+        {
+        }
+
+        decltype(auto) write(const void* p, size_t n)
+        {
+            crc = crc32c(crc, p, n);
+
+            return s.write(p, n);
+        }
+
+        uint32_t value() const noexcept
+        {
+            return crc;
+        }
+
+        S& s;
+        uint32_t crc;
+    };
+
+    // the kind of a type, numbers and pointers also fold their width and signedness in
+    // aggregates fold their member count, the shapes that are followed are listed in fingerprint below
+
+    template <typename T>
+    consteval uint64_t shape()
+    {
+        if constexpr(std::is_enum_v<T>)
+            return shape<std::underlying_type_t<T>>();
+        else if constexpr(std::is_same_v<T, bool>)
+            return 1;
+        else if constexpr(std::is_integral_v<T>)
+            return 2 | std::is_signed_v<T> << 2 | sizeof(T) << 3;
+        else if constexpr(std::is_floating_point_v<T>)
+            return 3 | sizeof(T) << 3;
+        else if constexpr(std::is_pointer_v<T> || requires (T t) { typename T::element_type; t.get(); })
+            return 4;
+        else if constexpr(requires { std::variant_size<T>::value; })
+            return 5 | std::variant_size_v<T> << 3;
+        else if constexpr(requires { typename T::value_type; } && requires (T t) { t.has_value(); })
+            return 6;
+        else if constexpr(is_fuple_v<T>)
+            return 7 | fuple_size_v<T> << 3;
+        else if constexpr(requires { typename T::first_type; typename T::second_type; })
+            return 8;
+        else if constexpr(std::ranges::range<T>)
+            return 9;
+        else if constexpr(is_delta_v<T>)
+            return 10 | arity_v<T> << 3;
+        else
+            return 11 | sizeof(T) << 3;
+    }
+
+    constexpr uint64_t mix(uint64_t h, uint64_t v)
+    {
+        for (size_t i = 0; i != sizeof(v); ++i, v >>= 8)
+             h = (h ^ (v & 0xff)) * 0x100000001b3;
+
+        return h;
+    }
+
+    // a hash of the shape of T, folded with the fingerprints of its members, alternatives, elements and pair halves
+    // only the reflected structure goes in, so it is the same under every compiler and standard library,
+    // and types that marshal alike, such as two structs with the same members or a vector and a list, share it
+    // pointees contribute their shape but are not followed, so recursive types have a fingerprint too
+
+    template <typename T>
+    consteval uint64_t fingerprint()
+    {
+        uint64_t h = mix(0xcbf29ce484222325, shape<T>());
+
+        auto fold = [&]<typename U>(std::type_identity<U>)
+        {
+            h = mix(h, fingerprint<std::remove_cv_t<U>>());
+        };
+
+        auto each = [&]<template <size_t, typename> typename E, size_t... N>(std::index_sequence<N...>)
+        {
+            (fold(std::type_identity<std::remove_cvref_t<typename E<N, T>::type>>()), ...);
+        };
+
+        if constexpr(std::is_enum_v<T>)
+            return fingerprint<std::underlying_type_t<T>>();
+        else if constexpr(std::is_pointer_v<T>)
+            h = mix(h, shape<std::remove_cv_t<std::remove_pointer_t<T>>>());
+        else if constexpr(requires (T t) { typename T::element_type; t.get(); })
+            h = mix(h, shape<std::remove_cv_t<std::remove_extent_t<typename T::element_type>>>());
+        else if constexpr(requires { std::variant_size<T>::value; })
+            each.template operator()<std::variant_alternative>(std::make_index_sequence<std::variant_size_v<T>>());
+        else if constexpr(requires { typename T::value_type; } && requires (T t) { t.has_value(); })
+            fold(std::type_identity<typename T::value_type>());
+        else if constexpr(is_fuple_v<T>)
+            each.template operator()<fuple_element>(std::make_index_sequence<fuple_size_v<T>>());
+        else if constexpr(requires { typename T::first_type; typename T::second_type; })
+        {
+            fold(std::type_identity<typename T::first_type>());
+            fold(std::type_identity<typename T::second_type>());
+        }
+        else if constexpr(std::ranges::range<T>)
+            fold(std::type_identity<std::ranges::range_value_t<T>>());
+        else if constexpr(is_delta_v<T>)
+        {
+            [&]<size_t... N>(std::index_sequence<N...>)
+            {
+                (fold(std::type_identity<std::remove_cvref_t<fuple_element_t<N, members_t<T>>>>()), ...);
+            }
+            (std::make_index_sequence<arity_v<T>>());
+        }
+
+        return h;
+    }
+
+    template <typename T>
+    inline constexpr uint64_t fingerprint_v = fingerprint<std::remove_cvref_t<T>>();
+
+    // a frame is a u64 payload length, the u64 fingerprint of the marshaled type, the payload marshaled under P
+    // and the u32 crc32c of everything before it, the words are in the byte order of P
+
+    inline constexpr size_t frame_header = 2 * sizeof(uint64_t);
+    inline constexpr size_t frame_trailer = sizeof(uint32_t);
+
+    template <policy P = policy(), typename T>
+    constexpr decltype(auto) framed_size_bytes(T&& t)
+    {
+        return frame_header + size_bytes<P>(std::forward<T>(t)) + frame_trailer;
+    }
+
+    // the crc is taken by the sink as the encoder writes, so the payload is never scanned a second time
+
+    template <policy P, sink S, typename T>
+    void write_frame(S& s, T&& t, uint64_t n)
+    {
+        crc_sink<S> c(s);
+        uint64_t f = fingerprint_v<T>;
+
+        marshal<frame_policy<P>>(c, n);
+        marshal<frame_policy<P>>(c, f);
+
+        marshal<P>(c, std::forward<T>(t));
+
+        uint32_t crc = c.value();
+        marshal<frame_policy<P>>(s, crc);
+    }
+
+    template <policy P = policy(), typename S, typename T>
+    constexpr decltype(auto) marshal_framed(S&& s, T&& t)
+    {
+        uint64_t n = size_bytes<P>(t);
+
+        if constexpr(requires { s.resize(0); })
+        {
+            size_t l = s.size();
+            s.resize(l + frame_header + n + frame_trailer);
+
+            fixed_sink f(s.data() + l, s.size() - l);
+            write_frame<P>(f, std::forward<T>(t), n);
+        }
+        else
+            write_frame<P>(s, std::forward<T>(t), n);
+
+        return std::forward<S>(s);
+    }
+
+    template <policy P = policy(), typename T>
+    constexpr decltype(auto) marshal_framed(T&& t)
+    {
+        std::string s;
+        marshal_framed<P>(s, std::forward<T>(t));
+
+        return s;
+    }
+
+    // unmarshals the frame at offset l of s into t and moves l past it
+    // false, with t and l untouched, when the frame is cut short, holds another type or fails its crc
+
+    template <policy P = policy(), typename S, typename T>
+    constexpr bool unmarshal_framed(size_t& l, S&& s, T&& t, std::pmr::memory_resource* mr = nullptr)
+    {
+        std::string_view v(s.data() + l, s.size() - l);
+
+        if (v.size() < frame_header + frame_trailer)
+            return 0;
+
+        auto n = unmarshal<frame_policy<P>, uint64_t>(v.substr(0, sizeof(uint64_t)));
+        auto f = unmarshal<frame_policy<P>, uint64_t>(v.substr(sizeof(uint64_t), sizeof(uint64_t)));
+
+        if (f != fingerprint_v<T> || n > v.size() - frame_header - frame_trailer)
+            return 0;
+
+        // the checksum is verified before decoding, so a corrupted length never drives an allocation
+        auto crc = unmarshal<frame_policy<P>, uint32_t>(v.substr(frame_header + n, frame_trailer));
+
+        if (crc32c(0, v.data(), frame_header + n) != crc)
+            return 0;
+
+        unmarshal<P>(v.substr(frame_header, n), std::forward<T>(t), mr);
+        l += frame_header + n + frame_trailer;
+
+        return 1;
+    }
+
+    template <policy P = policy(), typename S, typename T>
+    constexpr bool unmarshal_framed(S&& s, T&& t, std::pmr::memory_resource* mr = nullptr)
+    {
+        size_t l = 0;
+
+        return unmarshal_framed<P>(l, std::forward<S>(s), std::forward<T>(t), mr);
+    }
+
+    template <typename T, typename S>
+    constexpr decltype(auto) unmarshal_framed(S&& s, std::pmr::memory_resource* mr = nullptr)
+    {
+        std::optional<T> t(std::in_place);
+
+        if (!unmarshal_framed(std::forward<S>(s), *t, mr))
+            t.reset();
+
+        return t;
+    }
+
+    template <policy P, typename T, typename S>
+    constexpr decltype(auto) unmarshal_framed(S&& s, std::pmr::memory_resource* mr = nullptr)
+    {
+        std::optional<T> t(std::in_place);
+
+        if (!unmarshal_framed<P>(std::forward<S>(s), *t, mr))
+            t.reset();
+
+        return t;
+    }
+}
+
+#endif
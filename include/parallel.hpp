@@ -0,0 +1,435 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <numeric>
+#include <stdexcept>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+#include <reflect.hpp>
+
+namespace smp
+{
+    // a container whose elements are marshaled one after another, each independent of the others, can be cut into chunks
+    // graph ids and columns span the whole container, so those encodings stay serial
+
+    template <policy P, typename T, typename U = std::remove_cvref_t<T>>
+    inline constexpr bool splittable_v = std::ranges::random_access_range<U> && std::ranges::sized_range<U> && !P.graph &&
+                                         ! requires { typename U::key_type; } && !assigner<1, P>::template columnar<U>();
+
+    // the fewest elements worth handing to a thread of their own
+    inline constexpr size_t parallel_grain = 1 << 12;
+
+    // a fixed set of threads that run the tasks posted to them in order, they are joined when the pool is destroyed
+
+    struct thread_pool
+    {
+        thread_pool(size_t n)
+        {
+            workers.reserve(n);
+
+            for (size_t i = 0; i != n; ++i)
+                 workers.emplace_back([this](std::stop_token st){ run(st); });
+        }
+
+        thread_pool(const thread_pool&) = delete;
+
+        size_t size() const noexcept
+        {
+            return workers.size();
+        }
+
+        void post(std::function<void()> f)
+        {
+            {
+                std::lock_guard g(m);
+                tasks.push_back(std::move(f));
+            }
+
+            cv.notify_one();
+        }
+
+        void run(std::stop_token st)
+        {
+            for (;;)
+            {
+                std::function<void()> f;
+
+                {
+                    std::unique_lock g(m);
+
+                    if (!cv.wait(g, st, [this]{ return !tasks.empty(); }))
+                        return;
+
+                    f = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+
+                f();
+            }
+        }
+
+        std::mutex m;
+        std::condition_variable_any cv;
+
+        std::deque<std::function<void()>> tasks;
+        std::vector<std::jthread> workers;
+    };
+
+    // the pool every parallel call shares, one thread short of the hardware threads as the calling thread works too
+    // it is started on first use, so a program that never goes parallel never starts a thread
+
+    inline thread_pool& shared_pool()
+    {
+        static thread_pool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+
+        return pool;
+    }
+
+    // runs f(i) for every chunk i in [0, n), the calling thread and up to n - 1 threads of the shared pool take chunks
+    // in turn until none are left, so a parallel_for nested in a chunk makes progress even when the pool is busy
+    // the first exception thrown by f is rethrown once every chunk has run
+
+    template <typename F>
+    void parallel_for(size_t n, F&& f)
+    {
+        struct state
+        {
+            std::atomic<size_t> next = 0;
+            std::atomic<size_t> done = 0;
+
+            std::mutex m;
+            std::exception_ptr e;
+        };
+
+        auto st = std::make_shared<state>();
+
+        auto work = [&f, st](size_t i)
+        {
+            try
+            {
+                f(i);
+            }
+            catch (...)
+            {
+                std::lock_guard g(st->m);
+
+                if (!st->e)
+                    st->e = std::current_exception();
+            }
+        };
+
+        // a helper that starts after every chunk is taken returns without touching work, which may be gone by then
+        // the state is shared, as the caller may return as soon as the last chunk is counted
+        auto take = [st, &work, n]
+        {
+            for (size_t i; (i = st->next++) < n; )
+            {
+                 work(i);
+
+                 if (++st->done == n)
+                     st->done.notify_all();
+            }
+        };
+
+        auto& pool = shared_pool();
+
+        for (size_t i = 1; i < std::min(n, pool.size() + 1); ++i)
+             pool.post(take);
+
+        take();
+
+        for (size_t d; (d = st->done.load()) != n; )
+             st->done.wait(d);
+
+        if (st->e)
+            std::rethrow_exception(st->e);
+    }
+
+    // the number of chunks and the bounds of chunk i when n elements are shared among up to threads threads
+
+    inline size_t chunk_count(size_t n, size_t threads) noexcept
+    {
+        return std::max<size_t>(1, std::min(threads, n / parallel_grain));
+    }
+
+    inline std::pair<size_t, size_t> chunk_bounds(size_t n, size_t k, size_t i) noexcept
+    {
+        return { n * i / k, n * (i + 1) / k };
+    }
+
+    // marshals the length of t and its elements into s as marshal<P> does, the elements in blocks of stride elements
+    // blocks are sized in parallel, summed into offsets, s is sized once with extra bytes left at its end for the caller,
+    // then every thread encodes its run of blocks straight into its own slice of s
+    // a run is handed to the encoder as a subrange, so bitwise elements of a contiguous container are copied in bulk
+    // returns the offset of every block from the start of the encoding, followed by where the encoding ends
+
+    template <policy P, typename S, typename T>
+    std::vector<size_t> marshal_blocks(S& s, T& t, size_t stride, size_t threads, size_t extra = 0)
+    {
+        size_t n = std::ranges::size(t);
+        size_t b = (n + stride - 1) / stride;
+
+        size_t k = std::max<size_t>(1, std::min(threads, b));
+
+        size_t head = 0;
+        size_t size = n;
+
+        assigner<0, P>().template length<1>(head, std::string_view(), size);
+
+        std::vector<size_t> offsets(b + 1);
+        offsets[0] = head;
+
+        auto block = [&](size_t i, size_t m)
+        {
+            auto first = std::ranges::begin(t) + i;
+
+            return std::ranges::subrange(first, first + m);
+        };
+
+        parallel_for(k, [&](size_t i)
+        {
+            auto [lower, upper] = chunk_bounds(b, k, i);
+            assigner<0, P> a;
+
+            for (size_t j = lower; j != upper; ++j)
+            {
+                 size_t m = std::min(n, j * stride + stride) - j * stride;
+                 a.template browse<1>(offsets[j + 1], std::string_view(), block(j * stride, m), m);
+            }
+        });
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        size_t base = s.size();
+
+        size_t l = base;
+        size_t m = base + offsets[b] + extra;
+
+        auto encode = [&](auto p)
+        {
+            std::string_view v(p, m);
+            assigner<1, P>().template length<1>(l, v, size);
+
+            parallel_for(k, [&](size_t i)
+            {
+                auto [lower, upper] = chunk_bounds(b, k, i);
+
+                size_t o = base + offsets[lower];
+                size_t m = std::min(n, upper * stride) - lower * stride;
+
+                assigner<1, P>().template seq<1>(o, v, block(lower * stride, m), m);
+            });
+        };
+
+        if constexpr(requires { s.resize_and_overwrite(0, [](auto, auto n){ return n; }); })
+        {
+            s.resize_and_overwrite(m, [&](auto p, auto)
+            {
+                encode(p);
+
+                return m;
+            });
+        }
+        else
+        {
+            s.resize(m);
+            encode(s.data());
+        }
+
+        return offsets;
+    }
+
+    // marshals t into s byte for byte as marshal<P> does, with one block for every thread
+
+    template <policy P = policy(), typename S, typename T>
+    requires (!std::is_arithmetic_v<std::remove_cvref_t<T>>)
+    decltype(auto) marshal_parallel(S&& s, T&& t, size_t threads = std::thread::hardware_concurrency())
+    {
+        if constexpr(!splittable_v<P, T> || ! requires { s.resize(0); })
+            return marshal<P>(std::forward<S>(s), std::forward<T>(t));
+        else
+        {
+            size_t n = std::ranges::size(t);
+            size_t k = chunk_count(n, threads);
+
+            if (k == 1)
+                return marshal<P>(std::forward<S>(s), std::forward<T>(t));
+
+            marshal_blocks<P>(s, t, (n + k - 1) / k, k);
+
+            return std::forward<S>(s);
+        }
+    }
+
+    template <policy P = policy(), typename T>
+    decltype(auto) marshal_parallel(T&& t, size_t threads = std::thread::hardware_concurrency())
+    {
+        std::string s;
+        marshal_parallel<P>(s, std::forward<T>(t), threads);
+
+        return s;
+    }
+
+    // an indexed container is its marshal<P> encoding followed by the u64 offsets from the start of the encoding
+    // of every block of index_stride elements, the u64 stride and the u64 number of offsets, in the byte order of P
+    // the encoding up front stays readable by unmarshal, a container that can't be split is indexed with no offsets
+
+    inline constexpr size_t index_stride = parallel_grain;
+
+    template <policy P = policy(), typename S, typename T>
+    requires (!std::is_arithmetic_v<std::remove_cvref_t<T>>)
+    decltype(auto) marshal_indexed(S&& s, T&& t, size_t threads = std::thread::hardware_concurrency())
+    {
+        std::vector<size_t> offsets;
+
+        if constexpr(splittable_v<P, T> && requires { s.resize(0); })
+        {
+            size_t b = (std::ranges::size(t) + index_stride - 1) / index_stride;
+
+            offsets = marshal_blocks<P>(s, t, index_stride, threads, (b + 2) * sizeof(uint64_t));
+            offsets.pop_back();
+
+            fixed_sink f(s.data() + s.size() - (b + 2) * sizeof(uint64_t), (b + 2) * sizeof(uint64_t));
+
+            for (uint64_t o : offsets)
+                 marshal<frame_policy<P>>(f, o);
+
+            uint64_t stride = index_stride;
+            uint64_t count = b;
+
+            marshal<frame_policy<P>>(f, stride);
+            marshal<frame_policy<P>>(f, count);
+
+            return std::forward<S>(s);
+        }
+        else
+        {
+            uint64_t stride = index_stride;
+            uint64_t count = 0;
+
+            marshal<P>(s, std::forward<T>(t));
+
+            marshal<frame_policy<P>>(s, stride);
+            marshal<frame_policy<P>>(s, count);
+
+            return std::forward<S>(s);
+        }
+    }
+
+    template <policy P = policy(), typename T>
+    decltype(auto) marshal_indexed(T&& t, size_t threads = std::thread::hardware_concurrency())
+    {
+        std::string s;
+        marshal_indexed<P>(s, std::forward<T>(t), threads);
+
+        return s;
+    }
+
+    // unmarshals an indexed container, the container is sized up front and the blocks are decoded on threads threads
+    // straight into their own elements, so there is nothing left to merge
+    // the trailer is checked before anything is decoded, std::out_of_range is thrown when it doesn't fit the input,
+    // its count and stride disagree with the length of the container or an offset falls outside the encoding
+    // an allocating resource mr needn't be thread safe, the blocks are decoded on the calling thread when one is given
+
+    template <policy P = policy(), typename S, typename T>
+    requires (!std::is_arithmetic_v<std::remove_cvref_t<T>>)
+    decltype(auto) unmarshal_indexed(S&& s, T&& t, size_t threads = std::thread::hardware_concurrency(), std::pmr::memory_resource* mr = nullptr)
+    {
+        std::string_view v(s.data(), s.size());
+
+        auto word = [&](size_t at)
+        {
+            return unmarshal<frame_policy<P>, uint64_t>(v.substr(at, sizeof(uint64_t)));
+        };
+
+        if (v.size() < 2 * sizeof(uint64_t))
+            throw std::out_of_range("smp: indexed input too short for its trailer");
+
+        uint64_t b = word(v.size() - sizeof(uint64_t));
+        uint64_t stride = word(v.size() - 2 * sizeof(uint64_t));
+
+        if (b > v.size() / sizeof(uint64_t) - 2)
+            throw std::out_of_range("smp: index past the start of the input");
+
+        size_t table = v.size() - (b + 2) * sizeof(uint64_t);
+
+        if constexpr(splittable_v<P, T> && requires { t.resize(0); })
+        {
+            if (b)
+            {
+                size_t l = 0;
+                size_t n = 0;
+
+                assigner<1, P> a{ mr };
+
+                a.template length<0>(l, v, n);
+
+                if (!stride || b != n / stride + (n % stride != 0))
+                    throw std::out_of_range("smp: index disagrees with the length of the container");
+
+                for (size_t j = 0, o = l; j != b; ++j)
+                {
+                     size_t p = o;
+
+                     if ((o = word(table + j * sizeof(uint64_t))) < p || o > table)
+                         throw std::out_of_range("smp: index offset outside the encoding");
+                }
+
+                a.bind(t);
+                t.resize(n);
+
+                size_t k = mr ? 1 : std::max<size_t>(1, std::min<size_t>(threads, b));
+
+                parallel_for(k, [&](size_t i)
+                {
+                    auto [lower, upper] = chunk_bounds(b, k, i);
+
+                    size_t o = word(table + lower * sizeof(uint64_t));
+                    assigner<1, P> a{ mr };
+
+                    for (size_t e = lower * stride; e != std::min(n, upper * stride); ++e)
+                         a.template replicate<0>(o, v, t[e]);
+                });
+
+                return std::forward<T>(t);
+            }
+        }
+
+        return unmarshal<P>(v.substr(0, table), std::forward<T>(t), mr);
+    }
+
+    template <typename T, typename S>
+    decltype(auto) unmarshal_indexed(S&& s, size_t threads = std::thread::hardware_concurrency(), std::pmr::memory_resource* mr = nullptr)
+    {
+        T t;
+        unmarshal_indexed(std::forward<S>(s), t, threads, mr);
+
+        return t;
+    }
+
+    template <policy P, typename T, typename S>
+    decltype(auto) unmarshal_indexed(S&& s, size_t threads = std::thread::hardware_concurrency(), std::pmr::memory_resource* mr = nullptr)
+    {
+        T t;
+        unmarshal_indexed<P>(std::forward<S>(s), t, threads, mr);
+
+        return t;
+    }
+}
+
+#endif
@@ -0,0 +1,322 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+#ifndef RECORD_HPP
+#define RECORD_HPP
+
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <iterator>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <reflect.hpp>
+
+namespace smp
+{
+    // a record log is a data file of frames, each a u64 payload length followed by the payload marshaled under P
+    // the sidecar index file path + ".idx" holds the u64 offset of every frame, both in the byte order of P
+
+    // appends records to the end of a log, frames are buffered and handed to the files once the buffer fills up
+    // a log left behind by a writer that died between writing frames and indexing them is cut back to its last
+    // indexed frame when it is opened, so the frames that follow are indexed back to back
+
+    template <typename T, policy P = policy()>
+    struct record_writer
+    {
+        record_writer(const std::string& path, size_t size = 1 << 16) : size(size)
+        {
+            data = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+            index = ::open((path + ".idx").c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+
+            if (data >= 0 && index >= 0)
+                recover();
+        }
+
+        record_writer(const record_writer&) = delete;
+
+        ~record_writer()
+        {
+            flush();
+
+            if (data >= 0)
+                ::close(data);
+
+            if (index >= 0)
+                ::close(index);
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return data >= 0 && index >= 0 && good;
+        }
+
+        bool append(const T& t)
+        {
+            uint64_t n = size_bytes<P>(t);
+            uint64_t o = offset + frames.size();
+
+            marshal<frame_policy<P>>(offsets, o);
+            marshal<frame_policy<P>>(frames, n);
+
+            marshal<P>(frames, t);
+
+            if (frames.size() >= size)
+                flush();
+
+            return good;
+        }
+
+        bool flush()
+        {
+            // the index is written after the frames it points to, so it never refers to a missing frame
+            if (good && !frames.empty())
+            {
+                good = put(data, frames) && put(index, offsets);
+                offset += frames.size();
+
+                frames.clear();
+                offsets.clear();
+            }
+
+            return good;
+        }
+
+        static bool put(int fd, const std::string& s)
+        {
+            for (size_t i = 0; i != s.size(); )
+            {
+                 auto n = ::write(fd, s.data() + i, s.size() - i);
+
+                 if (n < 0 && errno != EINTR)
+                     return 0;
+
+                 if (n > 0)
+                     i += n;
+            }
+
+            return 1;
+        }
+
+        // reads the u64 at offset at of fd
+        static bool get(int fd, uint64_t at, uint64_t& w)
+        {
+            char b[sizeof(uint64_t)];
+
+            for (size_t i = 0; i != sizeof(b); )
+            {
+                 auto n = ::pread(fd, b + i, sizeof(b) - i, at + i);
+
+                 if (n == 0 || (n < 0 && errno != EINTR))
+                     return 0;
+
+                 if (n > 0)
+                     i += n;
+            }
+
+            w = unmarshal<frame_policy<P>, uint64_t>(std::string_view(b, sizeof(b)));
+
+            return 1;
+        }
+
+        // keeps the index entries up to the last one whose frame is whole, and the data up to the end of that frame
+        // a torn index word, entries past the data and frames that were never indexed are dropped
+        void recover()
+        {
+            struct stat ds, is;
+
+            if (::fstat(data, &ds) || ::fstat(index, &is))
+            {
+                good = 0;
+
+                return;
+            }
+
+            uint64_t end = ds.st_size;
+            uint64_t k = is.st_size / sizeof(uint64_t);
+
+            for (; k; --k)
+            {
+                 uint64_t o = 0;
+                 uint64_t n = 0;
+
+                 if (get(index, (k - 1) * sizeof(uint64_t), o) && o <= end && end - o >= sizeof(uint64_t) &&
+                     get(data, o, n) && n <= end - o - sizeof(uint64_t))
+                 {
+                     offset = o + sizeof(uint64_t) + n;
+
+                     break;
+                 }
+            }
+
+            if (k * sizeof(uint64_t) != uint64_t(is.st_size))
+                good = ::ftruncate(index, k * sizeof(uint64_t)) == 0;
+
+            if (offset != end)
+                good = ::ftruncate(data, offset) == 0 && good;
+        }
+
+        int data = -1;
+        int index = -1;
+
+        size_t size;
+        size_t offset = 0;
+
+        bool good = 1;
+
+        std::string frames;
+        std::string offsets;
+    };
+
+    // a read only mapping of a file, empty or missing files map to an empty view
+
+    struct mapped_file
+    {
+        mapped_file(const std::string& path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0)
+                return;
+
+            struct stat st;
+
+            if (::fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+                if (p != MAP_FAILED)
+                {
+                    head = static_cast<const char*>(p);
+                    size = st.st_size;
+                }
+            }
+
+            ::close(fd);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+
+        ~mapped_file()
+        {
+            if (head)
+                ::munmap(const_cast<char*>(head), size);
+        }
+
+        std::string_view view() const noexcept
+        {
+            return std::string_view(head, size);
+        }
+
+        const char* head = nullptr;
+        size_t size = 0;
+    };
+
+    // maps a log and its index, records are decoded straight from the mapping without reading the file into memory
+    // records are reached through the index only, frames that were never indexed are never seen
+
+    template <typename T, policy P = policy()>
+    struct record_reader
+    {
+        record_reader(const std::string& path) : data(path), index(path + ".idx")
+        {
+        }
+
+        struct iterator
+        {
+            using iterator_concept = std::forward_iterator_tag;
+            using iterator_category = std::input_iterator_tag;
+
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            T operator*() const
+            {
+                return unmarshal<P, T>(frame());
+            }
+
+            iterator& operator++() noexcept
+            {
+                ++n;
+
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                auto it = *this;
+                ++*this;
+
+                return it;
+            }
+
+            bool operator==(const iterator&) const = default;
+
+            std::string_view frame() const
+            {
+                return r->frame(n);
+            }
+
+            const record_reader* r = nullptr;
+            size_t n = 0;
+        };
+
+        static uint64_t word(const char* p)
+        {
+            return unmarshal<frame_policy<P>, uint64_t>(std::string_view(p, sizeof(uint64_t)));
+        }
+
+        size_t count() const noexcept
+        {
+            return index.size / sizeof(uint64_t);
+        }
+
+        // the marshaled payload of record n, in O(1) through the index
+        // throws std::out_of_range when n is past the index or the index points at a frame that doesn't fit in the data
+        std::string_view frame(size_t n) const
+        {
+            if (n >= count())
+                throw std::out_of_range("smp: record past the end of the index");
+
+            uint64_t o = word(index.head + n * sizeof(uint64_t));
+
+            if (o > data.size || data.size - o < sizeof(uint64_t))
+                throw std::out_of_range("smp: record offset past the end of the log");
+
+            uint64_t k = word(data.head + o);
+
+            if (k > data.size - o - sizeof(uint64_t))
+                throw std::out_of_range("smp: record frame past the end of the log");
+
+            return std::string_view(data.head + o + sizeof(uint64_t), k);
+        }
+
+        T operator[](size_t n) const
+        {
+            return unmarshal<P, T>(frame(n));
+        }
+
+        iterator begin() const noexcept
+        {
+            return iterator{ this, 0 };
+        }
+
+        iterator end() const noexcept
+        {
+            return iterator{ this, count() };
+        }
+
+        mapped_file data;
+        mapped_file index;
+    };
+}
+
+#endif
@@ -10,45 +10,39 @@
 #ifndef REFLECT_HPP
 #define REFLECT_HPP
 
+#include <bit>
+#include <map>
+#include <span>
+#include <array>
 #include <memory>
+#include <ranges>
+#include <vector>
+#include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <iomanip>
+#include <stdexcept>
+#include <variant>
+#include <optional>
+#include <typeinfo>
 #include <string_view>
+#include <memory_resource>
+#include <sink.hpp>
 #include <visitor.hpp>
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#   include <immintrin.h>
+#endif
+
 namespace smp
 {
-    #ifdef __GNUC__
-    #   pragma GCC diagnostic push
-    #   pragma GCC diagnostic ignored "-Wnon-template-friend"
-    #endif
-
-    template <size_t N, typename T>
-    struct dec_r
-    {
-        friend constexpr decltype(auto) adl_r(dec_r<N, T>);
-    };
-
-    template <typename R, size_t N, typename T>
-    struct def_r
-    {
-        friend constexpr decltype(auto) adl_r(dec_r<N, T>)
-        {
-            return R();
-        }
-    };
-
-    #ifdef __GNUC__
-    #   pragma GCC diagnostic pop
-    #endif
+    // converts to anything, so an aggregate takes as many of them as it has members
 
     template <size_t N, typename T>
     struct universal
     {
-        template <typename R, size_t = sizeof(def_r<R, N, T>)>
-        operator R()
-        {
-        }
+        template <typename R>
+        operator R() const;
     };
 
     template <typename T>
@@ -64,8 +58,203 @@ namespace smp
     template <typename T>
     inline constexpr auto arity_v = arity<T>();
 
+    // the member types are those of a structured binding of the aggregate, nothing is deduced from conversions,
+    // so members whose constructors probe their argument against other types, such as std::variant and std::optional,
+    // are reflected as they are declared, up to 64 members
+
+    template <template <typename ...> typename pack, typename... Args>
+    using bound = std::type_identity<pack<std::remove_cv_t<Args>...>>;
+
+    // SMP_IDS_N names the N bindings m0 to mN-1, SMP_TYPES maps a list of bindings to their decltypes
+    // with the __VA_OPT__ recursion of SMP_EXPAND, which rescans often enough for 64 names
+
+#define SMP_PARENS ()
+
+#define SMP_EXPAND(...) SMP_EXPAND3(SMP_EXPAND3(SMP_EXPAND3(SMP_EXPAND3(__VA_ARGS__))))
+#define SMP_EXPAND3(...) SMP_EXPAND2(SMP_EXPAND2(SMP_EXPAND2(SMP_EXPAND2(__VA_ARGS__))))
+#define SMP_EXPAND2(...) SMP_EXPAND1(SMP_EXPAND1(SMP_EXPAND1(SMP_EXPAND1(__VA_ARGS__))))
+#define SMP_EXPAND1(...) __VA_ARGS__
+
+#define SMP_TYPES(...) __VA_OPT__(SMP_EXPAND(SMP_TYPES_STEP(__VA_ARGS__)))
+#define SMP_TYPES_STEP(m, ...) decltype(m) __VA_OPT__(, SMP_TYPES_AGAIN SMP_PARENS (__VA_ARGS__))
+#define SMP_TYPES_AGAIN() SMP_TYPES_STEP
+
+#define SMP_IDS_1 m0
+#define SMP_IDS_2 SMP_IDS_1, m1
+#define SMP_IDS_3 SMP_IDS_2, m2
+#define SMP_IDS_4 SMP_IDS_3, m3
+#define SMP_IDS_5 SMP_IDS_4, m4
+#define SMP_IDS_6 SMP_IDS_5, m5
+#define SMP_IDS_7 SMP_IDS_6, m6
+#define SMP_IDS_8 SMP_IDS_7, m7
+#define SMP_IDS_9 SMP_IDS_8, m8
+#define SMP_IDS_10 SMP_IDS_9, m9
+#define SMP_IDS_11 SMP_IDS_10, m10
+#define SMP_IDS_12 SMP_IDS_11, m11
+#define SMP_IDS_13 SMP_IDS_12, m12
+#define SMP_IDS_14 SMP_IDS_13, m13
+#define SMP_IDS_15 SMP_IDS_14, m14
+#define SMP_IDS_16 SMP_IDS_15, m15
+#define SMP_IDS_17 SMP_IDS_16, m16
+#define SMP_IDS_18 SMP_IDS_17, m17
+#define SMP_IDS_19 SMP_IDS_18, m18
+#define SMP_IDS_20 SMP_IDS_19, m19
+#define SMP_IDS_21 SMP_IDS_20, m20
+#define SMP_IDS_22 SMP_IDS_21, m21
+#define SMP_IDS_23 SMP_IDS_22, m22
+#define SMP_IDS_24 SMP_IDS_23, m23
+#define SMP_IDS_25 SMP_IDS_24, m24
+#define SMP_IDS_26 SMP_IDS_25, m25
+#define SMP_IDS_27 SMP_IDS_26, m26
+#define SMP_IDS_28 SMP_IDS_27, m27
+#define SMP_IDS_29 SMP_IDS_28, m28
+#define SMP_IDS_30 SMP_IDS_29, m29
+#define SMP_IDS_31 SMP_IDS_30, m30
+#define SMP_IDS_32 SMP_IDS_31, m31
+#define SMP_IDS_33 SMP_IDS_32, m32
+#define SMP_IDS_34 SMP_IDS_33, m33
+#define SMP_IDS_35 SMP_IDS_34, m34
+#define SMP_IDS_36 SMP_IDS_35, m35
+#define SMP_IDS_37 SMP_IDS_36, m36
+#define SMP_IDS_38 SMP_IDS_37, m37
+#define SMP_IDS_39 SMP_IDS_38, m38
+#define SMP_IDS_40 SMP_IDS_39, m39
+#define SMP_IDS_41 SMP_IDS_40, m40
+#define SMP_IDS_42 SMP_IDS_41, m41
+#define SMP_IDS_43 SMP_IDS_42, m42
+#define SMP_IDS_44 SMP_IDS_43, m43
+#define SMP_IDS_45 SMP_IDS_44, m44
+#define SMP_IDS_46 SMP_IDS_45, m45
+#define SMP_IDS_47 SMP_IDS_46, m46
+#define SMP_IDS_48 SMP_IDS_47, m47
+#define SMP_IDS_49 SMP_IDS_48, m48
+#define SMP_IDS_50 SMP_IDS_49, m49
+#define SMP_IDS_51 SMP_IDS_50, m50
+#define SMP_IDS_52 SMP_IDS_51, m51
+#define SMP_IDS_53 SMP_IDS_52, m52
+#define SMP_IDS_54 SMP_IDS_53, m53
+#define SMP_IDS_55 SMP_IDS_54, m54
+#define SMP_IDS_56 SMP_IDS_55, m55
+#define SMP_IDS_57 SMP_IDS_56, m56
+#define SMP_IDS_58 SMP_IDS_57, m57
+#define SMP_IDS_59 SMP_IDS_58, m58
+#define SMP_IDS_60 SMP_IDS_59, m59
+#define SMP_IDS_61 SMP_IDS_60, m60
+#define SMP_IDS_62 SMP_IDS_61, m61
+#define SMP_IDS_63 SMP_IDS_62, m62
+#define SMP_IDS_64 SMP_IDS_63, m63
+
+#define SMP_BIND(N)                                                         \
+        else if constexpr(K == N)                                           \
+        {                                                                   \
+            auto& [SMP_IDS_##N] = t;                                        \
+                                                                            \
+            return bound<pack, SMP_TYPES(SMP_IDS_##N)>();                   \
+        }
+
+    template <template <typename ...> typename pack, size_t K, typename T>
+    constexpr auto bind_members(T& t)
+    {
+        if constexpr(K == 0)
+            return std::type_identity<pack<>>();
+        SMP_BIND(1) SMP_BIND(2) SMP_BIND(3) SMP_BIND(4) SMP_BIND(5) SMP_BIND(6) SMP_BIND(7) SMP_BIND(8)
+        SMP_BIND(9) SMP_BIND(10) SMP_BIND(11) SMP_BIND(12) SMP_BIND(13) SMP_BIND(14) SMP_BIND(15) SMP_BIND(16)
+        SMP_BIND(17) SMP_BIND(18) SMP_BIND(19) SMP_BIND(20) SMP_BIND(21) SMP_BIND(22) SMP_BIND(23) SMP_BIND(24)
+        SMP_BIND(25) SMP_BIND(26) SMP_BIND(27) SMP_BIND(28) SMP_BIND(29) SMP_BIND(30) SMP_BIND(31) SMP_BIND(32)
+        SMP_BIND(33) SMP_BIND(34) SMP_BIND(35) SMP_BIND(36) SMP_BIND(37) SMP_BIND(38) SMP_BIND(39) SMP_BIND(40)
+        SMP_BIND(41) SMP_BIND(42) SMP_BIND(43) SMP_BIND(44) SMP_BIND(45) SMP_BIND(46) SMP_BIND(47) SMP_BIND(48)
+        SMP_BIND(49) SMP_BIND(50) SMP_BIND(51) SMP_BIND(52) SMP_BIND(53) SMP_BIND(54) SMP_BIND(55) SMP_BIND(56)
+        SMP_BIND(57) SMP_BIND(58) SMP_BIND(59) SMP_BIND(60) SMP_BIND(61) SMP_BIND(62) SMP_BIND(63) SMP_BIND(64)
+        else
+            static_assert(K <= 64, "too many members to reflect");
+    }
+
+#undef SMP_BIND
+#undef SMP_IDS_1
+#undef SMP_IDS_2
+#undef SMP_IDS_3
+#undef SMP_IDS_4
+#undef SMP_IDS_5
+#undef SMP_IDS_6
+#undef SMP_IDS_7
+#undef SMP_IDS_8
+#undef SMP_IDS_9
+#undef SMP_IDS_10
+#undef SMP_IDS_11
+#undef SMP_IDS_12
+#undef SMP_IDS_13
+#undef SMP_IDS_14
+#undef SMP_IDS_15
+#undef SMP_IDS_16
+#undef SMP_IDS_17
+#undef SMP_IDS_18
+#undef SMP_IDS_19
+#undef SMP_IDS_20
+#undef SMP_IDS_21
+#undef SMP_IDS_22
+#undef SMP_IDS_23
+#undef SMP_IDS_24
+#undef SMP_IDS_25
+#undef SMP_IDS_26
+#undef SMP_IDS_27
+#undef SMP_IDS_28
+#undef SMP_IDS_29
+#undef SMP_IDS_30
+#undef SMP_IDS_31
+#undef SMP_IDS_32
+#undef SMP_IDS_33
+#undef SMP_IDS_34
+#undef SMP_IDS_35
+#undef SMP_IDS_36
+#undef SMP_IDS_37
+#undef SMP_IDS_38
+#undef SMP_IDS_39
+#undef SMP_IDS_40
+#undef SMP_IDS_41
+#undef SMP_IDS_42
+#undef SMP_IDS_43
+#undef SMP_IDS_44
+#undef SMP_IDS_45
+#undef SMP_IDS_46
+#undef SMP_IDS_47
+#undef SMP_IDS_48
+#undef SMP_IDS_49
+#undef SMP_IDS_50
+#undef SMP_IDS_51
+#undef SMP_IDS_52
+#undef SMP_IDS_53
+#undef SMP_IDS_54
+#undef SMP_IDS_55
+#undef SMP_IDS_56
+#undef SMP_IDS_57
+#undef SMP_IDS_58
+#undef SMP_IDS_59
+#undef SMP_IDS_60
+#undef SMP_IDS_61
+#undef SMP_IDS_62
+#undef SMP_IDS_63
+#undef SMP_IDS_64
+#undef SMP_TYPES_AGAIN
+#undef SMP_TYPES_STEP
+#undef SMP_TYPES
+#undef SMP_EXPAND1
+#undef SMP_EXPAND2
+#undef SMP_EXPAND3
+#undef SMP_EXPAND
+#undef SMP_PARENS
+
+    template <typename T, template <typename ...> typename pack = fuple>
+    struct members
+    {
+        using U = std::remove_cvref_t<T>;
+        using type = typename decltype(bind_members<pack, arity_v<U>>(std::declval<U&>()))::type;
+    };
+
+    template <typename T, template <typename ...> typename pack = fuple>
+    using members_t = typename members<T, pack>::type;
+
     template <size_t N, typename T, auto = 0>
-    using type_t = decltype(adl_r(dec_r<N, std::remove_cvref_t<T>>()));
+    using type_t = fuple_element_t<N, members_t<T>>;
 
     template <size_t N, typename T>
     struct member
@@ -96,21 +285,6 @@ namespace smp
     template <typename T>
     using object_t = typename object<T>::type;
 
-    template <typename T, template <typename ...> typename pack = fuple>
-    struct members
-    {
-        using U = std::remove_cvref_t<T>;
-
-        using type = decltype([]<size_t... N>(std::index_sequence<N...>)
-        {
-            return pack<type_t<N, U>...>();
-        }
-        (std::make_index_sequence<arity_v<U>>()));
-    };
-
-    template <typename T, template <typename ...> typename pack = fuple>
-    using members_t = typename members<T, pack>::type;
-
     template <typename T>
     using to_fuple_t = members_t<T>;
 
@@ -171,6 +345,110 @@ namespace smp
         return visitor<members_t<std::remove_cvref_t<T>>>().template offset<N>();
     }
 
+    template <typename T, typename U = std::remove_cvref_t<T>>
+    consteval bool bitwise()
+    {
+        if constexpr(std::is_enum_v<U> || std::is_fundamental_v<U>)
+            return 1;
+        else if constexpr(std::is_class_v<U> && std::is_aggregate_v<U> && std::is_trivially_copyable_v<U> && ! requires(U u) { u.begin(); })
+        {
+            using V = visitor<members_t<U>>;
+            using M = typename V::type;
+
+            constexpr size_t n = V::size();
+
+            if constexpr(n == 0)
+                return 0;
+            else
+            {
+                // every member is bitwise and starts right where the previous one ends
+                return []<size_t... N>(std::index_sequence<N...>)
+                {
+                    return (bitwise<fuple_element_t<N, M>>() && ...) &&
+                           ((V::template position<N + 1>() == V::template position<N>() + sizeof(fuple_element_t<N, M>)) && ...);
+                }
+                (std::make_index_sequence<n - 1>()) && bitwise<fuple_element_t<n - 1, M>>() &&
+                V::template position<n - 1>() + sizeof(fuple_element_t<n - 1, M>) == sizeof(U);
+            }
+        }
+        else
+            return 0;
+    }
+
+    template <typename T>
+    struct is_bitwise_serializable : std::bool_constant<bitwise<T>()>
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool is_bitwise_serializable_v = is_bitwise_serializable<T>::value;
+
+    template <typename T>
+    struct fixed_size_bytes : std::integral_constant<size_t, is_bitwise_serializable_v<T> ? sizeof(std::remove_cvref_t<T>) : 0>
+    {
+    };
+
+    template <typename T>
+    inline constexpr size_t fixed_size_bytes_v = fixed_size_bytes<T>::value;
+
+    template <typename T>
+    struct is_view : std::false_type
+    {
+    };
+
+    template <typename C, typename T>
+    struct is_view<std::basic_string_view<C, T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_view<std::span<const T>> : is_bitwise_serializable<T>
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool is_view_v = is_view<std::remove_cvref_t<T>>::value;
+
+    template <typename T>
+    struct view;
+
+    template <typename T>
+    using view_t = typename view<std::remove_cvref_t<T>>::type;
+
+    // maps owning members to views into the unmarshaled buffer, reflected aggregates become a smp::fuple of their mapped members
+
+    template <typename T>
+    struct view : std::type_identity<T>
+    {
+    };
+
+    template <typename C, typename T, typename A>
+    struct view<std::basic_string<C, T, A>> : std::type_identity<std::basic_string_view<C, T>>
+    {
+    };
+
+    template <typename T, typename A>
+    requires is_bitwise_serializable_v<T>
+    struct view<std::vector<T, A>> : std::type_identity<std::span<const T>>
+    {
+    };
+
+    template <typename... Args>
+    struct view<std::tuple<Args...>> : std::type_identity<std::tuple<view_t<Args>...>>
+    {
+    };
+
+    template <typename... Args>
+    struct view<fuple<Args...>> : std::type_identity<fuple<view_t<Args>...>>
+    {
+    };
+
+    template <typename T>
+    requires (std::is_class_v<T> && std::is_aggregate_v<T> && !is_bitwise_serializable_v<T> && ! requires(T t) { t.begin(); })
+    struct view<T> : view<members_t<T>>
+    {
+    };
+
     template <bool f, bool t, typename U>
     requires (!is_fuple_v<std::remove_cvref_t<U>> && !is_tuple_v<std::remove_cvref_t<U>>)
     static constexpr decltype(auto) expand(U&& u)
@@ -287,37 +565,638 @@ namespace smp
         (std::make_index_sequence<upper - lower>());
     }
 
+    // selects the wire encoding, the default one writes fixed width host order values
+
+    struct policy
+    {
+        // container and string lengths as LEB128 varints
+        bool varint = 0;
+
+        // integers wider than a byte as LEB128 varints, signed ones zigzag mapped first
+        bool zigzag = 0;
+
+        // byte order of multi-byte scalars, byte swapped on hosts of the other order
+        std::endian order = std::endian::native;
+
+        // classes as a field count followed by the index, the length and the payload of every field
+        // readers skip the fields they don't know and leave the ones they don't find defaulted
+        bool tagged = 0;
+
+        // ranges of reflected structs member by member, each member of all elements as one column
+        bool columnar = 0;
+
+        // pointers as 0 for null, the id of a pointee seen before, or the next id followed by the new pointee
+        // shared pointees are stored once and come back shared, cycles end at their back references
+        // a pointee reached by a shared_ptr after a raw pointer has no owner to share, marshal throws for it
+        bool graph = 0;
+    };
+
+    inline constexpr policy compact{ .varint = 1 };
+
+    inline constexpr policy portable{ .order = std::endian::little };
+
+    // lengths, offsets and checksums framing a payload marshaled under P share its byte order only
+
+    template <policy P>
+    inline constexpr policy frame_policy{ .order = P.order };
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    // the pshufb control that reverses every N byte lane of a 16 byte register
+
+    template <size_t N>
+    inline constexpr auto shuffle_mask = []
+    {
+        std::array<char, 16> m{};
+
+        for (size_t i = 0; i != m.size(); ++i)
+             m[i] = char(i / N * N + N - 1 - i % N);
+
+        return m;
+    }();
+
+    // reverse the bytes of as many whole registers of N byte scalars as fit in n scalars, return how many were done
+
+    template <size_t N>
+    __attribute__((target("avx2"))) inline size_t shuffle_avx2(unsigned char* q, size_t n) noexcept
+    {
+        auto m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shuffle_mask<N>.data()));
+        auto w = _mm256_broadcastsi128_si256(m);
+
+        size_t k = n / (32 / N) * (32 / N);
+
+        for (size_t i = 0; i != k * N; i += 32)
+        {
+             auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + i));
+             _mm256_storeu_si256(reinterpret_cast<__m256i*>(q + i), _mm256_shuffle_epi8(v, w));
+        }
+
+        return k;
+    }
+
+    template <size_t N>
+    __attribute__((target("ssse3"))) inline size_t shuffle_ssse3(unsigned char* q, size_t n) noexcept
+    {
+        auto m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shuffle_mask<N>.data()));
+
+        size_t k = n / (16 / N) * (16 / N);
+
+        for (size_t i = 0; i != k * N; i += 16)
+        {
+             auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i));
+             _mm_storeu_si128(reinterpret_cast<__m128i*>(q + i), _mm_shuffle_epi8(v, m));
+        }
+
+        return k;
+    }
+
+    // picks the widest shuffle the target is built for, or else the one the running cpu has
+
+    template <size_t N>
+    inline size_t shuffle_bytes(unsigned char* q, size_t n) noexcept
+    {
+#   if defined(__AVX2__)
+        return shuffle_avx2<N>(q, n);
+#   elif defined(__SSSE3__)
+        return shuffle_ssse3<N>(q, n);
+#   else
+        if (__builtin_cpu_supports("avx2"))
+            return shuffle_avx2<N>(q, n);
+        else if (__builtin_cpu_supports("ssse3"))
+            return shuffle_ssse3<N>(q, n);
+        else
+            return 0;
+#   endif
+    }
+#endif
+
+    // reverses the bytes of n consecutive N byte scalars in place, whole registers with pshufb on x86-64,
+    // the rest one scalar at a time
+
+    template <size_t N>
+    constexpr void swap_bytes(void* p, size_t n) noexcept
+    {
+        auto q = static_cast<unsigned char*>(p);
+
+        if constexpr(N == 2 || N == 4 || N == 8)
+        {
+            using U = std::conditional_t<N == 2, uint16_t, std::conditional_t<N == 4, uint32_t, uint64_t>>;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+            if (!std::is_constant_evaluated())
+            {
+                size_t k = shuffle_bytes<N>(q, n);
+
+                q += k * N;
+                n -= k;
+            }
+#endif
+
+            for (size_t i = 0; i != n; ++i, q += N)
+            {
+                 U u;
+                 std::memcpy(&u, q, N);
+
+                 u = std::byteswap(u);
+                 std::memcpy(q, &u, N);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i != n; ++i, q += N)
+                 std::reverse(q, q + N);
+        }
+    }
+
     template <bool C, bool B, typename U, typename L, typename S, typename T>
     constexpr decltype(auto) copy(L&& l, S&& s, T&& t, size_t size = sizeof(U))
     {
         if constexpr(!C)
             return size;
 
-        if constexpr(B && requires { s.resize(0); })
-            s.resize(l + size);
+        if constexpr(B && sink<std::remove_cvref_t<S>>)
+            s.write(std::addressof(t), size);
+        else
+        {
+            auto dst = (void*)(s.data() + l);
+            auto src = (void*)std::addressof(std::forward<T>(t));
 
-        auto dst = (void*)(s.data() + l);
-        auto src = (void*)std::addressof(std::forward<T>(t));
+            if constexpr(B)
+                std::memcpy(dst, src, size);
+            else
+                std::memcpy(src, dst, size);
+        }
+
+        return size;
+    }
+
+    template <bool C, bool B, typename L, typename S>
+    constexpr decltype(auto) varint(L&& l, S&& s, uint64_t& v)
+    {
+        uint8_t b[10];
+        size_t n = 0;
 
         if constexpr(B)
-            std::memcpy(dst, src, size);
+        {
+            for (uint64_t u = v; ; u >>= 7)
+            {
+                 b[n++] = (u & 0x7f) | (u > 0x7f) << 7;
+
+                 if (u <= 0x7f)
+                     break;
+            }
+
+            return copy<C, B, uint8_t>(std::forward<L>(l), std::forward<S>(s), b[0], n);
+        }
         else
-            std::memcpy(src, dst, size);
+        {
+            v = 0;
 
-        return size;
+            // a u64 takes at most 10 groups of 7 bits, the last holding only the top bit
+            do
+            {
+                copy<C, B, uint8_t>(l + n, std::forward<S>(s), b[0]);
+
+                if (n == 9 && b[0] > 1)
+                    throw std::invalid_argument("smp: varint longer than 64 bits");
+
+                v |= uint64_t(b[0] & 0x7f) << 7 * n++;
+            }
+            while (b[0] & 0x80);
+
+            return n;
+        }
+    }
+
+    // ordered containers were marshaled in key order, so a hint at end() makes every insertion amortized O(1)
+
+    template <typename T, typename... Args>
+    constexpr decltype(auto) insert(T& t, Args&&... args)
+    {
+        if constexpr(requires { typename T::key_compare; })
+            t.emplace_hint(t.end(), std::forward<Args>(args)...);
+        else
+            t.emplace(std::forward<Args>(args)...);
     }
 
-    template <bool C>
+    template <typename T>
+    struct copy_plan
+    {
+        using V = visitor<members_t<T>>;
+
+        template <size_t N>
+        using type = fuple_element_t<N, typename V::type>;
+
+        template <size_t N>
+        static constexpr bool fixed()
+        {
+            return is_bitwise_serializable_v<type<N>>;
+        }
+
+        // member N starts right where the bitwise member N - 1 ends, so it is copied along with it
+        template <size_t N>
+        static constexpr bool joined()
+        {
+            if constexpr(N == 0)
+                return 0;
+            else
+                return fixed<N - 1>() && fixed<N>() && V::template position<N>() == V::template position<N - 1>() + sizeof(type<N - 1>);
+        }
+
+        // the length of the coalesced byte run that starts at member N
+        template <size_t N>
+        static constexpr size_t bytes()
+        {
+            if constexpr(N + 1 == V::size())
+                return sizeof(type<N>);
+            else if constexpr(joined<N + 1>())
+                return sizeof(type<N>) + bytes<N + 1>();
+            else
+                return sizeof(type<N>);
+        }
+    };
+
+    template <bool C, policy P = policy()>
     struct assigner
     {
+        static constexpr bool swap = P.order != std::endian::native;
+
+        // U allocates through a std::pmr::memory_resource
+        template <typename U>
+        static constexpr bool pmr()
+        {
+            if constexpr(requires { typename U::allocator_type; typename U::value_type; })
+                return std::is_same_v<typename U::allocator_type, std::pmr::polymorphic_allocator<typename U::value_type>>;
+            else
+                return 0;
+        }
+
+        // a pmr U is made on mr, any other U on the heap, so the strings and vectors inside a pointee placed on mr
+        // stay on the heap unless they are pmr themselves
+        template <typename U>
+        constexpr U make() const
+        {
+            if constexpr(pmr<U>())
+                return mr ? U(typename U::allocator_type(mr)) : U();
+            else
+                return U();
+        }
+
+        // rebuilds an empty pmr container on mr, polymorphic allocators don't propagate on assignment
+        // containers with other allocators are left as they are and keep allocating from the heap
+        template <typename T>
+        constexpr void bind(T& t) const
+        {
+            using U = std::remove_cvref_t<T>;
+
+            if constexpr(pmr<U>() && !std::is_const_v<T>)
+            {
+                if (mr && t.get_allocator().resource() != mr)
+                {
+                    std::destroy_at(std::addressof(t));
+                    std::construct_at(std::addressof(t), typename U::allocator_type(mr));
+                }
+            }
+        }
+
+        // U is copied as its raw bytes under this policy
+        template <typename U>
+        static constexpr bool flat()
+        {
+            if constexpr(!is_bitwise_serializable_v<U> || (P.tagged && std::is_class_v<U>))
+                return 0;
+            else if constexpr(P.zigzag && (std::is_class_v<U> || (std::is_integral_v<U> && sizeof(U) > 1)))
+                return 0;
+            else
+                return !swap || (!std::is_class_v<U> && sizeof(U) == 1);
+        }
+
+        // U is a scalar copied with its bytes reversed under this policy
+        template <typename U>
+        static constexpr bool swapped()
+        {
+            return swap && (std::is_arithmetic_v<U> || std::is_enum_v<U>) && sizeof(U) > 1;
+        }
+
+        template <bool B, typename L, typename S, typename U>
+        constexpr decltype(auto) order(L&& l, S&& s, U* p, size_t n)
+        {
+            using V = std::remove_const_t<U>;
+            size_t size = n * sizeof(V);
+
+            if constexpr(!C || !B)
+            {
+                copy<C, B, V>(std::forward<L>(l), std::forward<S>(s), *p, size);
+
+                if constexpr(C)
+                    swap_bytes<sizeof(V)>(p, n);
+            }
+            else if constexpr(sink<std::remove_cvref_t<S>>)
+            {
+                V b[256];
+
+                for (size_t i = 0; i < n; i += std::size(b))
+                {
+                     size_t k = std::min(n - i, std::size(b));
+                     std::memcpy(b, p + i, k * sizeof(V));
+
+                     swap_bytes<sizeof(V)>(b, k);
+                     s.write(b, k * sizeof(V));
+                }
+            }
+            else
+            {
+                copy<C, B, V>(std::forward<L>(l), std::forward<S>(s), *p, size);
+                swap_bytes<sizeof(V)>((void*)(s.data() + l), n);
+            }
+
+            return size;
+        }
+
+        template <bool B, typename L, typename S, typename T>
+        constexpr decltype(auto) scalar(L&& l, S&& s, T&& t)
+        {
+            using U = std::remove_cvref_t<T>;
+
+            if constexpr(swapped<U>())
+                l += order<B>(std::forward<L>(l), std::forward<S>(s), std::addressof(t), 1);
+            else
+                l += copy<C, B, U>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
+        }
+
+        // a range of V is transposed into one column per member of V
+        template <typename U>
+        static constexpr bool columnar()
+        {
+            if constexpr(std::ranges::forward_range<U>)
+            {
+                using V = std::ranges::range_value_t<U>;
+
+                return P.columnar && !P.tagged && std::is_aggregate_v<V> && std::is_class_v<V> && !std::ranges::range<V>;
+            }
+            else
+                return 0;
+        }
+
+        // the length of a range of unknown size can be written after its elements, into a slot left for it
+        // sizing never writes, a fixed width length is patched in place, or through a sink that can patch
+        template <typename S>
+        static constexpr bool patchable()
+        {
+            using R = std::remove_cvref_t<S>;
+
+            if constexpr(!C)
+                return 1;
+            else if constexpr(P.varint)
+                return 0;
+            else if constexpr(sink<R>)
+                return requires(R& r, const void* p) { r.patch(0, p, 0); r.length(); };
+            else
+                return 1;
+        }
+
+        // leaves room for a u64 that is known only once what follows it is written, returns where the room is
+        template <typename L, typename S>
+        constexpr size_t reserve(L&& l, S&& s)
+        {
+            size_t slot = l;
+
+            if constexpr(sink<std::remove_cvref_t<S>>)
+            {
+                uint64_t v = 0;
+
+                slot = s.length();
+                s.write(&v, sizeof(v));
+            }
+
+            l += sizeof(uint64_t);
+
+            return slot;
+        }
+
+        // writes v into the room left by reserve
+        template <typename S>
+        constexpr void settle(size_t slot, S&& s, uint64_t v)
+        {
+            if constexpr(sink<std::remove_cvref_t<S>>)
+            {
+                if constexpr(swap)
+                    v = std::byteswap(v);
+
+                s.patch(slot, &v, sizeof(v));
+            }
+            else
+                scalar<1>(slot, std::forward<S>(s), v);
+        }
+
+        // the number of bytes written so far
+        template <typename L, typename S>
+        static constexpr size_t written(L&& l, S&& s)
+        {
+            if constexpr(C && sink<std::remove_cvref_t<S>>)
+                return s.length();
+            else
+                return l;
+        }
+
+        // walks a range without size() once, counting its elements as they are written
+        template <typename L, typename S, typename T>
+        constexpr decltype(auto) unsized(L&& l, S&& s, T&& t)
+        {
+            using U = std::remove_cvref_t<T>;
+
+            size_t size = 0;
+            size_t slot = 0;
+
+            if constexpr(!C && element_size<U>())
+            {
+                size = std::ranges::distance(t);
+                l += size * element_size<U>();
+            }
+            else
+            {
+                if constexpr(C)
+                    slot = reserve(std::forward<L>(l), std::forward<S>(s));
+
+                for (auto&& v : t)
+                {
+                     replicate<1>(std::forward<L>(l), std::forward<S>(s), v);
+                     ++size;
+                }
+            }
+
+            if constexpr(!C)
+                length<1>(std::forward<L>(l), std::forward<S>(s), size);
+            else
+                settle(slot, std::forward<S>(s), size);
+        }
+
+        // a single pass range whose length can't be patched is encoded into a buffer first, then copied after its length
+        template <typename L, typename S, typename T>
+        constexpr decltype(auto) buffered(L&& l, S&& s, T&& t)
+        {
+            std::string b;
+            append_sink a(b);
+
+            size_t k = 0;
+            size_t size = 0;
+
+            for (auto&& v : t)
+            {
+                 replicate<1>(k, a, v);
+                 ++size;
+            }
+
+            length<1>(std::forward<L>(l), std::forward<S>(s), size);
+
+            if (!b.empty())
+                l += copy<C, 1, char>(std::forward<L>(l), std::forward<S>(s), b[0], b.size());
+        }
+
+        // the encoded size of every U when it doesn't depend on the value, 0 when it does
+        template <typename U>
+        static constexpr size_t fixed_size()
+        {
+            if constexpr(P.zigzag && std::is_integral_v<U> && sizeof(U) > 1)
+                return 0;
+            else if constexpr(flat<U>())
+                return fixed_size_bytes_v<U>;
+            else if constexpr(swapped<U>())
+                return sizeof(U);
+            else if constexpr(!std::is_class_v<U> || P.tagged || requires { typename U::weak_type; })
+                return 0;
+            else if constexpr(requires { std::tuple_size<U>::value; } && std::ranges::contiguous_range<U>)
+            {
+                // std::array, its length is a constant too
+                constexpr size_t n = std::tuple_size<U>::value;
+                constexpr size_t e = element_size<U>();
+
+                if constexpr(n && !e)
+                    return 0;
+                else
+                    return (P.varint ? std::max<size_t>(1, (std::bit_width(n) + 6) / 7) : sizeof(uint64_t)) + n * e;
+            }
+            else if constexpr(std::is_aggregate_v<U> && !is_fuple_v<U> && !std::ranges::range<U>)
+            {
+                return []<size_t... N>(std::index_sequence<N...>)
+                {
+                    constexpr size_t sizes[] = { 0, fixed_size<std::remove_cvref_t<fuple_element_t<N, members_t<U>>>>()... };
+
+                    return std::ranges::count(sizes, 0) > 1 ? 0 : (sizes[N + 1] + ... + 0);
+                }
+                (std::make_index_sequence<arity_v<U>>());
+            }
+            else
+                return 0;
+        }
+
+        // the encoded size of every element of the range U when it doesn't depend on the value, 0 when it does
+        template <typename U>
+        static constexpr size_t element_size()
+        {
+            if constexpr(columnar<U>())
+                return 0;
+            else if constexpr(requires { typename U::key_type; typename U::mapped_type; })
+            {
+                constexpr size_t k = fixed_size<typename U::key_type>();
+                constexpr size_t m = fixed_size<typename U::mapped_type>();
+
+                return k && m ? k + m : 0;
+            }
+            else
+                return fixed_size<std::ranges::range_value_t<U>>();
+        }
+
+        template <bool B, typename L, typename S, typename T>
+        constexpr decltype(auto) column(L&& l, S&& s, T&& t)
+        {
+            using U = std::ranges::range_value_t<std::remove_cvref_t<T>>;
+            using V = visitor<members_t<U>>;
+
+            [&]<size_t... N>(std::index_sequence<N...>)
+            {
+                (..., [&]
+                {
+                    using M = fuple_element_t<N, typename V::type>;
+
+                    if constexpr(!C && flat<M>())
+                        l += std::ranges::distance(t) * sizeof(M);
+                    else
+                    {
+                        for (auto& u : t)
+                             replicate<B>(std::forward<L>(l), std::forward<S>(s), V().template get<N>(u));
+                    }
+                }());
+            }
+            (std::make_index_sequence<V::size()>());
+        }
+
+        template <bool B, typename L, typename S>
+        constexpr decltype(auto) length(L&& l, S&& s, size_t& size)
+        {
+            uint64_t v = size;
+
+            if constexpr(P.varint)
+                l += varint<C, B>(std::forward<L>(l), std::forward<S>(s), v);
+            else
+                scalar<B>(std::forward<L>(l), std::forward<S>(s), v);
+
+            size = v;
+        }
+
+        template <bool B, typename L, typename S, typename T>
+        constexpr decltype(auto) integer(L&& l, S&& s, T&& t)
+        {
+            using U = std::remove_cvref_t<T>;
+            using V = std::make_unsigned_t<U>;
+
+            uint64_t v = 0;
+
+            if constexpr(B)
+            {
+                if constexpr(std::is_signed_v<U>)
+                    v = V(V(t) << 1) ^ V(t < 0 ? -1 : 0);
+                else
+                    v = t;
+            }
+
+            l += varint<C, B>(std::forward<L>(l), std::forward<S>(s), v);
+
+            if constexpr(!B)
+            {
+                if constexpr(std::is_signed_v<U>)
+                    t = U(V(v >> 1) ^ V(-V(v & 1)));
+                else
+                    t = U(v);
+            }
+        }
+
         template <bool B, typename L, typename S, typename T>
         constexpr decltype(auto) seq(L&& l, S&& s, T&& t, size_t size)
         {
+            using U = std::remove_cvref_t<T>;
+
             if constexpr(!B && requires { t.resize(0); })
                 t.resize(size);
 
-            for (auto& v : t)
-                 replicate<B>(std::forward<L>(l), std::forward<S>(s), v);
+            using V = std::ranges::range_value_t<U>;
+
+            if constexpr(columnar<U>())
+                column<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
+            else if constexpr(std::ranges::contiguous_range<U> && std::ranges::sized_range<U> && flat<V>())
+            {
+                if (size_t n = std::ranges::size(t))
+                    l += copy<C, B, V>(std::forward<L>(l), std::forward<S>(s), *std::ranges::data(t), n * sizeof(V));
+            }
+            else if constexpr(std::ranges::contiguous_range<U> && std::ranges::sized_range<U> && swapped<V>())
+            {
+                if (size_t n = std::ranges::size(t))
+                    l += order<B>(std::forward<L>(l), std::forward<S>(s), std::ranges::data(t), n);
+            }
+            else
+            {
+                for (auto&& v : t)
+                     replicate<B>(std::forward<L>(l), std::forward<S>(s), v);
+            }
         }
 
         template <bool B, typename L, typename S, typename T, typename U = std::remove_cvref_t<T>>
@@ -334,7 +1213,10 @@ namespace smp
         {
             using U = std::remove_cvref_t<T>;
 
-            if constexpr(! requires { typename U::key_type; typename U::value_type; })
+            // nor does sizing a container of elements of constant size
+            if constexpr(!C && B && element_size<U>())
+                l += size * element_size<U>();
+            else if constexpr(! requires { typename U::key_type; typename U::value_type; })
                 seq<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t), size);
             else
                 ass<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t), size);
@@ -358,68 +1240,362 @@ namespace smp
         template <bool B, typename U, typename L, typename S, typename T>
         constexpr decltype(auto) assign(L&& l, S&& s, T&& t, size_t size)
         {
+            if constexpr(requires { t.reserve(size); })
+                t.reserve(t.size() + size);
+
             for (size_t i = 0; i != size; ++i)
             {
-                 typename U::key_type key;
+                 auto key = make<typename U::key_type>();
                  replicate<B>(std::forward<L>(l), std::forward<S>(s), key);
 
                  if constexpr(! requires { typename U::mapped_type; })
-                     t.emplace(key);
+                     insert(t, std::move(key));
                  else
                  {
-                     typename U::mapped_type val;
+                     auto val = make<typename U::mapped_type>();
                      replicate<B>(std::forward<L>(l), std::forward<S>(s), val);
 
-                     t.emplace(key, val);
-                 }
+                     insert(t, std::move(key), std::move(val));
+                 }
+            }
+        }
+
+        template <bool B, typename L, typename S, typename T>
+        constexpr decltype(auto) assign(L&& l, S&& s, T&& t, size_t size)
+        {
+            if constexpr(!B)
+                t.resize(size);
+
+            l += copy<C, B, size_t>(std::forward<L>(l), std::forward<S>(s), t[0], size);
+        }
+
+        template <bool B, typename L, typename S, typename T>
+        constexpr decltype(auto) label(L&& l, S&& s, T&& t)
+        {
+            size_t n = 0;
+
+            if constexpr(B)
+            {
+                smp::for_each([&](auto&&){ ++n; }, t);
+                length<B>(std::forward<L>(l), std::forward<S>(s), n);
+
+                smp::for_each([&, j = size_t(0)]<typename V>(V&& v) mutable
+                {
+                    size_t i = j++;
+                    length<B>(std::forward<L>(l), std::forward<S>(s), i);
+
+                    if constexpr(!C)
+                    {
+                        // sized in place, the payload before its length, with the graph state it will be written with
+                        size_t e = l;
+                        replicate<B>(std::forward<L>(l), std::forward<S>(s), std::forward<V>(v));
+
+                        size_t size = l - e;
+                        length<B>(std::forward<L>(l), std::forward<S>(s), size);
+                    }
+                    else if constexpr(patchable<S>())
+                    {
+                        // the payload is written once and its length patched in before it, as for unsized ranges
+                        size_t slot = reserve(std::forward<L>(l), std::forward<S>(s));
+                        size_t e = written(l, s);
+
+                        replicate<B>(std::forward<L>(l), std::forward<S>(s), std::forward<V>(v));
+                        settle(slot, std::forward<S>(s), written(l, s) - e);
+                    }
+                    else
+                    {
+                        // a varint length or a sink that can't patch needs the size up front, the payload is sized on
+                        // the ids handed out so far and the ids it hands out are taken back before it is written
+                        size_t size = 0;
+                        assigner<0, P> a;
+
+                        if constexpr(P.graph)
+                        {
+                            size_t mark = seen.size();
+
+                            std::swap(a.ids, ids);
+                            std::swap(a.seen, seen);
+
+                            a.template replicate<1>(size, std::string_view(), v);
+
+                            std::swap(a.ids, ids);
+                            std::swap(a.seen, seen);
+
+                            for (; seen.size() > mark; seen.pop_back())
+                                 ids.erase(seen.back());
+                        }
+                        else
+                            a.template replicate<1>(size, std::string_view(), v);
+
+                        length<B>(std::forward<L>(l), std::forward<S>(s), size);
+                        replicate<B>(std::forward<L>(l), std::forward<S>(s), std::forward<V>(v));
+                    }
+                }, std::forward<T>(t));
+            }
+            else
+            {
+                length<B>(std::forward<L>(l), std::forward<S>(s), n);
+
+                for (size_t k = 0; k != n; ++k)
+                {
+                     size_t i = 0;
+                     size_t size = 0;
+
+                     length<B>(std::forward<L>(l), std::forward<S>(s), i);
+                     length<B>(std::forward<L>(l), std::forward<S>(s), size);
+
+                     size_t e = l + size;
+
+                     // an unknown index matches no field and its payload is jumped over untouched
+                     smp::for_each([&, j = size_t(0)]<typename V>(V&& v) mutable
+                     {
+                         if (j++ == i)
+                             replicate<B>(std::forward<L>(l), std::forward<S>(s), std::forward<V>(v));
+                     }, std::forward<T>(t));
+
+                     l = e;
+                }
+            }
+        }
+
+        template <bool B, typename L, typename S, typename T>
+        constexpr decltype(auto) assign(L&& l, S&& s, T&& t)
+        {
+            using U = std::remove_cvref_t<T>;
+
+            if constexpr(P.tagged)
+                label<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
+            else if constexpr(std::is_aggregate_v<U> && !P.zigzag && !swap)
+            {
+                using R = copy_plan<U>;
+                using V = typename R::V;
+
+                [&]<size_t... N>(std::index_sequence<N...>)
+                {
+                    (..., [&]
+                    {
+                        decltype(auto) m = V().template get<N>(std::forward<T>(t));
+
+                        if constexpr(!R::template joined<N>())
+                        {
+                            if constexpr(R::template fixed<N>())
+                                l += copy<C, B, std::byte>(std::forward<L>(l), std::forward<S>(s), m, R::template bytes<N>());
+                            else
+                                replicate<B>(std::forward<L>(l), std::forward<S>(s), m);
+                        }
+                    }());
+                }
+                (std::make_index_sequence<V::size()>());
+            }
+            else
+            {
+                smp::for_each([&]<typename V>(V&& v)
+                {
+                    replicate<B>(std::forward<L>(l), std::forward<S>(s), std::forward<V>(v));
+                }, std::forward<T>(t));
+            }
+
+            if constexpr(B)
+                return std::forward<S>(s);
+            else
+                return std::forward<T>(t);
+        }
+
+        template <typename L, typename S, typename T>
+        constexpr decltype(auto) refer(L&& l, S&& s, T&& t, size_t size)
+        {
+            using U = std::remove_cvref_t<T>;
+            using V = typename U::value_type;
+
+            static_assert(flat<V>() && !columnar<U>(), "views can only refer to elements copied as their raw bytes");
+
+            if (l > s.size() || size > (s.size() - l) / sizeof(V))
+                throw std::out_of_range("smp: viewed elements run past the end of the input");
+
+            auto p = s.data() + l;
+
+            // a span over misaligned elements is undefined, so such input is refused rather than viewed
+            if constexpr(alignof(V) > 1)
+            {
+                if (reinterpret_cast<std::uintptr_t>(p) % alignof(V))
+                    throw std::invalid_argument("smp: misaligned elements can not be viewed");
+            }
+
+            t = U(reinterpret_cast<const V*>(p), size);
+            l += size * sizeof(V);
+        }
+
+        template <typename T>
+        constexpr void create(T& t)
+        {
+            using U = std::remove_cvref_t<T>;
+
+            if constexpr(std::is_pointer_v<U>)
+            {
+                using V = std::remove_pointer_t<U>;
+
+                // pointees placed in a memory resource are released with it and must not be deleted
+                // their destructors never run, so members that aren't pmr leak their heap storage when it is released
+                if (mr)
+                    t = new (mr->allocate(sizeof(V), alignof(V))) V();
+                else
+                    t = new V();
+            }
+            else
+            {
+                using V = typename U::element_type;
+
+                // destroyed with the last owner, which has to go before mr is released
+                if (mr)
+                    t = std::allocate_shared<V>(std::pmr::polymorphic_allocator<V>(mr));
+                else
+                    t = std::make_shared<V>();
+            }
+        }
+
+        template <bool B, typename L, typename S, typename T>
+        constexpr decltype(auto) link(L&& l, S&& s, T&& t)
+        {
+            using U = std::remove_cvref_t<T>;
+            using V = std::remove_cvref_t<decltype(*t)>;
+
+            size_t id = 0;
+
+            if constexpr(B)
+            {
+                bool fresh = 0;
+                bool shared = requires { typename U::weak_type; };
+
+                if (t)
+                {
+                    auto p = static_cast<const void*>(std::addressof(*t));
+                    auto r = ids.try_emplace({ p, &typeid(V) }, ids.size() + 1, shared);
+
+                    // a pointee decoded for a raw pointer has no owner a shared_ptr could later share
+                    if (shared && !r.first->second.second)
+                        throw std::invalid_argument("smp: a pointee first reached through a raw pointer can not be shared");
+
+                    id = r.first->second.first;
+                    fresh = r.second;
+
+                    if (fresh)
+                        seen.push_back(r.first);
+                }
+
+                length<B>(std::forward<L>(l), std::forward<S>(s), id);
+
+                if (fresh)
+                    replicate<B>(std::forward<L>(l), std::forward<S>(s), *t);
+            }
+            else
+            {
+                length<B>(std::forward<L>(l), std::forward<S>(s), id);
+
+                if (!id)
+                    t = U();
+                else if (id <= objs.size())
+                {
+                    auto& [p, sp] = objs[id - 1];
+
+                    if constexpr(std::is_pointer_v<U>)
+                        t = static_cast<U>(p);
+                    else
+                    {
+                        if (!sp)
+                            throw std::invalid_argument("smp: a pointee first reached through a raw pointer can not be shared");
+
+                        t = U(sp, static_cast<V*>(p));
+                    }
+                }
+                else if (id != objs.size() + 1)
+                    throw std::invalid_argument("smp: reference to a pointee that was never decoded");
+                else
+                {
+                    // the pointee is registered before it is filled, so references back to it resolve
+                    create(t);
+
+                    if constexpr(std::is_pointer_v<U>)
+                        objs.emplace_back(const_cast<V*>(t), nullptr);
+                    else
+                        objs.emplace_back(const_cast<V*>(t.get()), t);
+
+                    replicate<B>(std::forward<L>(l), std::forward<S>(s), *t);
+                }
             }
         }
 
-        template <bool B, typename L, typename S, typename T>
-        constexpr decltype(auto) assign(L&& l, S&& s, T&& t, size_t size)
+        template <size_t N, typename L, typename S, typename U>
+        static constexpr void alternative(assigner& a, L& l, S& s, U& u)
         {
-            if constexpr(!B)
-                t.resize(size);
-
-            l += copy<C, B, size_t>(std::forward<L>(l), std::forward<S>(s), t[0], size);
+            a.template replicate<0>(l, s, u.template emplace<N>());
         }
 
+        // the index of the active alternative followed by it, decoded through a table indexed by the alternative
+        // a valueless variant is written as variant_npos alone, which, like any index past the alternatives, is refused
         template <bool B, typename L, typename S, typename T>
-        constexpr decltype(auto) assign(L&& l, S&& s, T&& t)
+        constexpr decltype(auto) select(L&& l, S&& s, T&& t)
         {
-            smp::for_each([&]<typename U>(U&& u)
-            {
-                if constexpr(C && B && requires { s.resize(0); })
-                    l = s.length();
+            using U = std::remove_cvref_t<T>;
+            size_t i = t.index();
 
-                replicate<B>(std::forward<L>(l), std::forward<S>(s), std::forward<U>(u));
-            }, std::forward<T>(t));
+            length<B>(std::forward<L>(l), std::forward<S>(s), i);
 
             if constexpr(B)
-                return std::forward<S>(s);
+            {
+                if (!t.valueless_by_exception())
+                {
+                    std::visit([&](auto& v)
+                    {
+                        replicate<B>(std::forward<L>(l), std::forward<S>(s), v);
+                    }, t);
+                }
+            }
             else
-                return std::forward<T>(t);
+            {
+                using F = void (*)(assigner&, std::remove_reference_t<L>&, std::remove_reference_t<S>&, U&);
+
+                static constexpr auto table = []<size_t... N>(std::index_sequence<N...>)
+                {
+                    return std::array<F, sizeof...(N)>{ &assigner::template alternative<N, std::remove_reference_t<L>, std::remove_reference_t<S>, U>... };
+                }
+                (std::make_index_sequence<std::variant_size_v<U>>());
+
+                // an index past the alternatives leaves their bytes unread, so the members after it can't be found
+                if (i >= table.size())
+                    throw std::invalid_argument("smp: variant index past its alternatives");
+
+                table[i](*this, l, s, t);
+            }
         }
 
         template <bool B, typename L, typename S, typename T>
-        constexpr decltype(auto) replicate(L&& l, S&& s, T&& t)
+        constexpr auto replicate(L&& l, S&& s, T&& t) -> std::conditional_t<B, S&&, T&&>
         {
             using U = std::remove_cvref_t<T>;
 
-            if constexpr(std::is_enum_v<U> || std::is_fundamental_v<U>)
-                l += copy<C, B, U>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
+            // sizing a value of constant size takes no traversal at all
+            if constexpr(!C && B && fixed_size<U>())
+                l += fixed_size<U>();
+            else if constexpr(P.zigzag && std::is_integral_v<U> && sizeof(U) > 1)
+                integer<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
+            else if constexpr(flat<U>())
+                l += copy<C, B, U>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t), fixed_size_bytes_v<U>);
+            else if constexpr(swapped<U>())
+                scalar<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
             else if constexpr(std::is_pointer_v<U> || requires { typename U::weak_type; })
             {
-                if constexpr(!B)
+                if constexpr(P.graph)
+                    link<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
+                else
                 {
-                    if constexpr(std::is_pointer_v<U>)
-                        t = new std::remove_pointer_t<U>();
-                    else
-                        t = std::make_shared<typename U::element_type>();
-                }
+                    if constexpr(!B)
+                        create(t);
 
-                replicate<B>(std::forward<L>(l), std::forward<S>(s), *t);
+                    replicate<B>(std::forward<L>(l), std::forward<S>(s), *t);
+                }
             }
+            else if constexpr(requires { t.index(); t.valueless_by_exception(); })
+                select<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
             else if constexpr(requires { t.has_value(); })
             {
                 bool size = t.has_value();
@@ -433,8 +1609,15 @@ namespace smp
                     replicate<B>(std::forward<L>(l), std::forward<S>(s), *t);
                 }
             }
+            else if constexpr(B && ! requires { t.size(); } && requires { t.begin(); t.end(); } && !columnar<U>() && patchable<S>())
+                unsized(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
+            else if constexpr(B && ! requires { t.size(); } && std::ranges::input_range<U> && !std::ranges::forward_range<U>)
+                buffered(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t));
             else if constexpr(requires { t.begin(); t.end(); })
             {
+                if constexpr(!B)
+                    bind(t);
+
                 size_t size = 0;
 
                 if constexpr(requires { t.size(); })
@@ -442,10 +1625,12 @@ namespace smp
                 else
                     size = B * std::distance(t.begin(), t.end());
 
-                l += copy<C, B, size_t>(std::forward<L>(l), std::forward<S>(s), size);
+                length<B>(std::forward<L>(l), std::forward<S>(s), size);
 
                 if constexpr(std::is_same_v<U, std::string>)
                     assign<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t), size);
+                else if constexpr(!B && is_view_v<U>)
+                    refer(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t), size);
                 else
                     browse<B>(std::forward<L>(l), std::forward<S>(s), std::forward<T>(t), size);
             }
@@ -457,28 +1642,82 @@ namespace smp
             else
                 return std::forward<T>(t);
         }
+
+        // where unmarshal places pmr containers and pointees, the global heap when null
+        std::pmr::memory_resource* mr = nullptr;
+
+        struct none
+        {
+        };
+
+        using id_map = std::map<std::pair<const void*, const std::type_info*>, std::pair<size_t, bool>>;
+
+        // the ids of the pointees marshaled so far in the order they were handed out, and the pointees unmarshaled
+        // so far in id order
+        [[no_unique_address]] std::conditional_t<P.graph, id_map, none> ids{};
+        [[no_unique_address]] std::conditional_t<P.graph, std::vector<typename id_map::iterator>, none> seen{};
+        [[no_unique_address]] std::conditional_t<P.graph, std::vector<std::pair<void*, std::shared_ptr<void>>>, none> objs{};
     };
 
-    template <typename T>
+    // the encoded size of every T under P when it doesn't depend on the value, 0 when it does
+
+    template <typename T, policy P = policy()>
+    inline constexpr size_t static_size_bytes_v = assigner<0, P>::template fixed_size<std::remove_cvref_t<T>>();
+
+    template <policy P = policy(), typename T>
     constexpr decltype(auto) size_bytes(T&& t)
     {
         size_t l = 0;
-        assigner<0>().replicate<1>(l, std::string_view(), std::forward<T>(t));
+        assigner<0, P>().template replicate<1>(l, std::string_view(), std::forward<T>(t));
 
         return l;
     }
 
-    template <typename S, typename T>
+    template <policy P = policy(), typename S, typename T>
     constexpr decltype(auto) marshal(S&& s, T&& t)
     {
-        return assigner<1>().replicate<1>(0, std::forward<S>(s), std::forward<T>(t));
+        using U = std::remove_cvref_t<T>;
+
+        // a single pass range can't be walked once for its size and again for its bytes
+        if constexpr(requires { s.resize(0); } && std::ranges::input_range<U> && !std::ranges::forward_range<U>)
+        {
+            append_sink a(s);
+            assigner<1, P>().template replicate<1>(0, a, std::forward<T>(t));
+
+            return std::forward<S>(s);
+        }
+        else if constexpr(requires { s.resize(0); })
+        {
+            size_t l = s.size();
+            size_t n = size_bytes<P>(t);
+
+            // size the destination once, then write with raw pointer bumps
+            if constexpr(requires { s.resize_and_overwrite(0, [](auto, auto n){ return n; }); })
+            {
+                s.resize_and_overwrite(l + n, [&](auto p, auto)
+                {
+                    assigner<1, P>().template replicate<1>(l, std::string_view(p, l + n), std::forward<T>(t));
+
+                    return l;
+                });
+            }
+            else
+            {
+                s.resize(l + n);
+                assigner<1, P>().template replicate<1>(l, s, std::forward<T>(t));
+            }
+
+            return std::forward<S>(s);
+        }
+        else
+            return assigner<1, P>().template replicate<1>(0, std::forward<S>(s), std::forward<T>(t));
     }
 
-    template <typename T>
+    template <policy P = policy(), typename T>
     constexpr decltype(auto) marshal(T&& t)
     {
         std::string s;
-        marshal(s, std::forward<T>(t));
+        marshal<P>(s, std::forward<T>(t));
 
         return s;
     }
@@ -517,32 +1756,41 @@ namespace smp
     template <typename T>
     constexpr decltype(auto) marshal(char* data, size_t size, T&& t)
     {
-        std::string_view s(data, size);
+        fixed_sink s(data, size);
         marshal(s, std::forward<T>(t));
 
-        return s;
+        return std::string_view(data, s.overflow() ? 0 : s.length());
     }
 
-    template <typename S, typename T>
-    constexpr decltype(auto) unmarshal(size_t& l, S&& s, T&& t)
+    template <policy P = policy(), typename S, typename T>
+    constexpr decltype(auto) unmarshal(size_t& l, S&& s, T&& t, std::pmr::memory_resource* mr = nullptr)
     {
-        return assigner<1>().replicate<0>(l, std::forward<S>(s), std::forward<T>(t));
+        return assigner<1, P>{ mr }.template replicate<0>(l, std::forward<S>(s), std::forward<T>(t));
     }
 
-    template <typename S, typename T>
-    constexpr decltype(auto) unmarshal(S&& s, T&& t)
+    template <policy P = policy(), typename S, typename T>
+    constexpr decltype(auto) unmarshal(S&& s, T&& t, std::pmr::memory_resource* mr = nullptr)
     {
         size_t l = 0;
-        unmarshal(l, std::forward<S>(s), std::forward<T>(t));
+        unmarshal<P>(l, std::forward<S>(s), std::forward<T>(t), mr);
 
         return std::forward<T>(t);
     }
 
     template <typename T, typename S>
-    constexpr decltype(auto) unmarshal(S&& s)
+    constexpr decltype(auto) unmarshal(S&& s, std::pmr::memory_resource* mr = nullptr)
     {
         T t;
-        unmarshal(std::forward<S>(s), t);
+        unmarshal(std::forward<S>(s), t, mr);
+
+        return t;
+    }
+
+    template <policy P, typename T, typename S>
+    constexpr decltype(auto) unmarshal(S&& s, std::pmr::memory_resource* mr = nullptr)
+    {
+        T t;
+        unmarshal<P>(std::forward<S>(s), t, mr);
 
         return t;
     }
@@ -873,6 +2121,409 @@ namespace smp
         return lt(std::forward<U>(u), std::forward<T>(t));
     }
 
+    // a delta of a reflected aggregate is a bitmap with a bit per member, set for the members that differ from the base
+    // followed by the current value of those members in order, a member that is a reflected aggregate itself is written as a delta of its own
+
+    template <typename T>
+    inline constexpr bool is_delta_v = std::is_class_v<T> && std::is_aggregate_v<T> && !is_fuple_v<T> && ! requires(T t) { t.begin(); };
+
+    template <policy P>
+    struct delta
+    {
+        template <typename T>
+        static constexpr bool same(const T& a, const T& b)
+        {
+            if constexpr(is_bitwise_serializable_v<T>)
+                return !std::memcmp(&a, &b, sizeof(T));
+            else if constexpr(is_delta_v<T>)
+            {
+                return [&]<size_t... N>(std::index_sequence<N...>)
+                {
+                    return (same(get<N>(a), get<N>(b)) && ...);
+                }
+                (std::make_index_sequence<arity_v<T>>());
+            }
+            else if constexpr(std::is_pointer_v<T> || requires { a.use_count(); })
+                return a == b || (a && b && same(*a, *b));
+            else if constexpr(requires { a.has_value(); *a; })
+                return a.has_value() == b.has_value() && (!a || same(*a, *b));
+            else if constexpr(requires { a.first; a.second; })
+                return same(a.first, b.first) && same(a.second, b.second);
+            else if constexpr(std::ranges::contiguous_range<T> && is_bitwise_serializable_v<std::ranges::range_value_t<T>>)
+            {
+                size_t n = std::ranges::size(a);
+
+                return n == std::ranges::size(b) && (!n || !std::memcmp(std::ranges::data(a), std::ranges::data(b), n * sizeof(std::ranges::range_value_t<T>)));
+            }
+            else if constexpr(std::ranges::range<T>)
+                return std::ranges::equal(a, b, [](const auto& x, const auto& y){ return same(x, y); });
+            else if constexpr(requires { a.index(); a.valueless_by_exception(); })
+                return marshal<P>(a) == marshal<P>(b);
+            else if constexpr(requires { a != b; })
+                return smp::eq(a, b);
+            else
+                return marshal<P>(a) == marshal<P>(b);
+        }
+
+        template <typename S, typename T>
+        static constexpr void encode(S& s, const T& base, const T& t)
+        {
+            size_t k = s.size();
+            s.resize(k + (arity_v<T> + 7) / 8);
+
+            [&]<size_t... N>(std::index_sequence<N...>)
+            {
+                ([&]
+                {
+                    decltype(auto) x = get<N>(base);
+                    decltype(auto) y = get<N>(t);
+
+                    if (!same(x, y))
+                    {
+                        s[k + N / 8] |= char(1 << N % 8);
+
+                        if constexpr(is_delta_v<std::remove_cvref_t<decltype(y)>>)
+                            encode(s, x, y);
+                        else
+                            marshal<P>(s, y);
+                    }
+                }(), ...);
+            }
+            (std::make_index_sequence<arity_v<T>>());
+        }
+
+        template <typename S, typename T>
+        static constexpr void decode(size_t& l, S& s, T& t)
+        {
+            size_t k = l;
+            l += (arity_v<T> + 7) / 8;
+
+            [&]<size_t... N>(std::index_sequence<N...>)
+            {
+                ([&]
+                {
+                    if (!(uint8_t(s[k + N / 8]) >> N % 8 & 1))
+                        return;
+
+                    decltype(auto) m = get<N>(t);
+                    using M = std::remove_cvref_t<decltype(m)>;
+
+                    if constexpr(is_delta_v<M>)
+                        decode(l, s, m);
+                    else if constexpr(std::is_pointer_v<M> && !P.graph)
+                    {
+                        // a raw pointee is patched where it is, so the object never leaks or dangles
+                        if (m)
+                        {
+                            *m = std::remove_cvref_t<decltype(*m)>();
+                            unmarshal<P>(l, s, *m);
+                        }
+                        else
+                            unmarshal<P>(l, s, m);
+                    }
+                    else
+                    {
+                        // the member is reset first, containers and optionals are refilled rather than merged into
+                        m = M();
+                        unmarshal<P>(l, s, m);
+                    }
+                }(), ...);
+            }
+            (std::make_index_sequence<arity_v<T>>());
+        }
+    };
+
+    template <policy P = policy(), typename S, typename T>
+    requires is_delta_v<T>
+    constexpr decltype(auto) marshal_delta(S&& s, const T& base, const T& t)
+    {
+        delta<P>::encode(s, base, t);
+
+        return std::forward<S>(s);
+    }
+
+    template <policy P = policy(), typename T>
+    requires is_delta_v<T>
+    constexpr decltype(auto) marshal_delta(const T& base, const T& t)
+    {
+        std::string s;
+        marshal_delta<P>(s, base, t);
+
+        return s;
+    }
+
+    template <policy P = policy(), typename S, typename T>
+    requires is_delta_v<std::remove_cvref_t<T>>
+    constexpr decltype(auto) apply_delta(size_t& l, S&& s, T&& t)
+    {
+        delta<P>::decode(l, s, t);
+
+        return std::forward<T>(t);
+    }
+
+    template <policy P = policy(), typename T, typename S>
+    requires is_delta_v<std::remove_cvref_t<T>>
+    constexpr decltype(auto) apply_delta(T&& t, S&& s)
+    {
+        size_t l = 0;
+
+        return apply_delta<P>(l, std::forward<S>(s), std::forward<T>(t));
+    }
+
+    // a table of a reflected aggregate leads with the u64 end offset of every member from the start of the table,
+    // in the byte order of P, followed by the members marshaled under P, so any one member is found in O(1)
+    // every member starts at the next multiple of 8 past the end of the one before, zero padded, so the elements
+    // of a string or of a vector of bitwise elements are aligned in an aligned buffer and can be viewed in place
+
+    template <typename T>
+    inline constexpr size_t table_header = arity_v<T> * sizeof(uint64_t);
+
+    inline constexpr size_t table_align = alignof(uint64_t);
+
+    constexpr size_t table_start(size_t end) noexcept
+    {
+        return (end + table_align - 1) & ~(table_align - 1);
+    }
+
+    template <policy P = policy(), typename S, typename T>
+    requires is_delta_v<std::remove_cvref_t<T>>
+    constexpr decltype(auto) marshal_table(S&& s, T&& t)
+    {
+        using U = std::remove_cvref_t<T>;
+
+        std::array<uint64_t, arity_v<U>> starts;
+        std::array<uint64_t, arity_v<U>> ends;
+
+        uint64_t o = table_header<U>;
+
+        [&]<size_t... N>(std::index_sequence<N...>)
+        {
+            ((starts[N] = table_start(o), ends[N] = o = starts[N] + size_bytes<P>(get<N>(t))), ...);
+
+            if constexpr(requires { s.resize(0); })
+            {
+                size_t l = s.size();
+                s.resize(l + o);
+
+                fixed_sink f(s.data() + l, table_header<U>);
+
+                for (auto e : ends)
+                     marshal<frame_policy<P>>(f, e);
+
+                (assigner<1, P>().template replicate<1>(l + starts[N], s, get<N>(t)), ...);
+            }
+            else
+            {
+                for (auto e : ends)
+                     marshal<frame_policy<P>>(s, e);
+
+                o = table_header<U>;
+
+                ([&]
+                {
+                    static constexpr char zeros[table_align] = {};
+
+                    s.write(zeros, starts[N] - o);
+                    marshal<P>(s, get<N>(t));
+
+                    o = ends[N];
+                }(), ...);
+            }
+        }
+        (std::make_index_sequence<arity_v<U>>());
+
+        return std::forward<S>(s);
+    }
+
+    template <policy P = policy(), typename T>
+    requires is_delta_v<std::remove_cvref_t<T>>
+    constexpr decltype(auto) marshal_table(T&& t)
+    {
+        std::string s;
+        marshal_table<P>(s, std::forward<T>(t));
+
+        return s;
+    }
+
+    template <policy P = policy(), typename S, typename T>
+    requires is_delta_v<std::remove_cvref_t<T>>
+    constexpr decltype(auto) unmarshal_table(S&& s, T&& t, std::pmr::memory_resource* mr = nullptr)
+    {
+        using U = std::remove_cvref_t<T>;
+        size_t l = table_header<U>;
+
+        [&]<size_t... N>(std::index_sequence<N...>)
+        {
+            (unmarshal<P>(l = table_start(l), s, get<N>(t), mr), ...);
+        }
+        (std::make_index_sequence<arity_v<U>>());
+
+        return std::forward<T>(t);
+    }
+
+    template <typename T, typename S>
+    constexpr decltype(auto) unmarshal_table(S&& s, std::pmr::memory_resource* mr = nullptr)
+    {
+        T t;
+        unmarshal_table(std::forward<S>(s), t, mr);
+
+        return t;
+    }
+
+    template <policy P, typename T, typename S>
+    constexpr decltype(auto) unmarshal_table(S&& s, std::pmr::memory_resource* mr = nullptr)
+    {
+        T t;
+        unmarshal_table<P>(std::forward<S>(s), t, mr);
+
+        return t;
+    }
+
+    // the bytes of member N of the T tabled in v
+
+    template <policy P, size_t N, typename T>
+    constexpr std::string_view table_member(std::string_view v)
+    {
+        auto word = [&](size_t i) -> size_t
+        {
+            return unmarshal<frame_policy<P>, uint64_t>(v.substr(i * sizeof(uint64_t), sizeof(uint64_t)));
+        };
+
+        size_t lower = table_start(N ? word(N - 1) : table_header<T>);
+
+        return v.substr(lower, word(N) - lower);
+    }
+
+    // the index of the first member of type U in T
+    template <typename U, typename T>
+    inline constexpr size_t member_position_v = []<size_t... N>(std::index_sequence<N...>)
+    {
+        constexpr bool same[] = { std::is_same_v<U, std::remove_cvref_t<fuple_element_t<N, members_t<T>>>>... };
+
+        return size_t(std::ranges::find(same, 1) - same);
+    }
+    (std::make_index_sequence<arity_v<T>>());
+
+    // M can be viewed in place under P, its elements are laid out in the input as they are in memory
+
+    template <policy P, typename M>
+    constexpr bool viewable()
+    {
+        if constexpr(is_view_v<view_t<M>> && !P.varint)
+            return assigner<1, P>::template flat<std::ranges::range_value_t<M>>() && !assigner<1, P>::template columnar<M>();
+        else
+            return 0;
+    }
+
+    // member N of the T tabled in s, strings and vectors of bitwise elements come back as views into s
+    // when lengths are fixed width, views need s to stay alive and, for spans, to be aligned
+
+    template <policy P, size_t N, typename T, typename S>
+    constexpr decltype(auto) peek(S&& s)
+    {
+        using M = std::remove_cvref_t<fuple_element_t<N, members_t<T>>>;
+        auto u = table_member<P, N, T>(std::string_view(s.data(), s.size()));
+
+        if constexpr(viewable<P, M>())
+            return unmarshal<P, view_t<M>>(u);
+        else
+            return unmarshal<P, M>(u);
+    }
+
+    template <size_t N, typename T, typename S>
+    constexpr decltype(auto) peek(S&& s)
+    {
+        return peek<policy{}, N, T>(std::forward<S>(s));
+    }
+
+    template <policy P, typename U, typename T, typename S>
+    constexpr decltype(auto) peek(S&& s)
+    {
+        return peek<P, member_position_v<U, T>, T>(std::forward<S>(s));
+    }
+
+    template <typename U, typename T, typename S>
+    constexpr decltype(auto) peek(S&& s)
+    {
+        return peek<policy{}, U, T>(std::forward<S>(s));
+    }
+
+    template <typename... Args>
+    using optionals = std::tuple<std::optional<Args>...>;
+
+    // a proxy over the table of a T in a buffer that outlives it, a member is decoded the first time it is asked for
+    // and kept from then on, members never asked for are never decoded and never allocate
+    // get fills the cache even through a const lazy, so unlike a const member function of the standard library
+    // it isn't safe to call from several threads at once, lock around it or ask for every member before sharing one
+
+    template <typename T, policy P = policy{}>
+    struct lazy
+    {
+        using type = T;
+
+        constexpr lazy(std::string_view s) noexcept : s(s)
+        {
+        }
+
+        template <size_t N>
+        constexpr const auto& get() const
+        {
+            auto& m = std::get<N>(cache);
+
+            if (!m)
+                unmarshal<P>(table_member<P, N, T>(s), m.emplace());
+
+            return *m;
+        }
+
+        template <size_t N>
+        constexpr bool cached() const noexcept
+        {
+            return std::get<N>(cache).has_value();
+        }
+
+        // the whole T, members decoded already are copied from the cache
+        constexpr T value() const
+        {
+            T t;
+
+            [&]<size_t... N>(std::index_sequence<N...>)
+            {
+                ((smp::get<N>(t) = get<N>()), ...);
+            }
+            (std::make_index_sequence<arity_v<T>>());
+
+            return t;
+        }
+
+        std::string_view s;
+        mutable members_t<T, optionals> cache;
+    };
+
+    template <size_t N, typename T, policy P>
+    constexpr decltype(auto) get(lazy<T, P>& l)
+    {
+        return l.template get<N>();
+    }
+
+    template <size_t N, typename T, policy P>
+    constexpr decltype(auto) get(const lazy<T, P>& l)
+    {
+        return l.template get<N>();
+    }
+
+    template <typename U, typename T, policy P>
+    constexpr decltype(auto) get(lazy<T, P>& l)
+    {
+        return l.template get<member_position_v<U, T>>();
+    }
+
+    template <typename U, typename T, policy P>
+    constexpr decltype(auto) get(const lazy<T, P>& l)
+    {
+        return l.template get<member_position_v<U, T>>();
+    }
+
     template <typename T = std::void_t<>>
     struct less
     {
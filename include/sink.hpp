@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2022-present DeepGrace (complex dot invoke at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/deepgrace/smp
+//
+
+#ifndef SINK_HPP
+#define SINK_HPP
+
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace smp
+{
+    // anything the marshal engine can append bytes to, in order
+
+    template <typename T>
+    concept sink = requires(T t, const void* p, size_t n)
+    {
+        t.write(p, n);
+    };
+
+    // a bounded buffer owned by the caller, writes past its end are dropped and reported
+
+    struct fixed_sink
+    {
+        constexpr fixed_sink(void* data, size_t size) noexcept : buff(static_cast<char*>(data)), size(size)
+        {
+        }
+
+        constexpr bool write(const void* p, size_t n) noexcept
+        {
+            if (full || n > size - used)
+                return !(full = 1);
+
+            std::memcpy(buff + used, p, n);
+            used += n;
+
+            return 1;
+        }
+
+        // overwrites n bytes written before at offset at
+        constexpr bool patch(size_t at, const void* p, size_t n) noexcept
+        {
+            if (full || at > used || n > used - at)
+                return 0;
+
+            std::memcpy(buff + at, p, n);
+
+            return 1;
+        }
+
+        constexpr char* data() const noexcept
+        {
+            return buff;
+        }
+
+        constexpr size_t length() const noexcept
+        {
+            return used;
+        }
+
+        constexpr size_t capacity() const noexcept
+        {
+            return size;
+        }
+
+        constexpr bool overflow() const noexcept
+        {
+            return full;
+        }
+
+        char* buff;
+
+        size_t size;
+        size_t used = 0;
+
+        bool full = 0;
+    };
+
+    // appends to a growable buffer of bytes such as std::string, unlike marshal into s it doesn't size the value first
+
+    template <typename S>
+    struct append_sink
+    {
+        constexpr append_sink(S& s) noexcept : s(s), base(s.size())
+        {
+        }
+
+        constexpr void write(const void* p, size_t n)
+        {
+            size_t m = s.size();
+
+            s.resize(m + n);
+            std::memcpy(s.data() + m, p, n);
+        }
+
+        constexpr bool patch(size_t at, const void* p, size_t n) noexcept
+        {
+            std::memcpy(s.data() + base + at, p, n);
+
+            return 1;
+        }
+
+        constexpr size_t length() const noexcept
+        {
+            return s.size() - base;
+        }
+
+        S& s;
+        size_t base;
+    };
+
+    // buffers writes internally and hands every filled chunk to a flush callback f(const char*, size_t)
+
+    template <typename F>
+    struct chunk_sink
+    {
+        chunk_sink(F f, size_t size = 1 << 16) : f(std::move(f)), buff(std::make_unique_for_overwrite<char[]>(size)), size(size)
+        {
+        }
+
+        bool write(const void* p, size_t n)
+        {
+            auto q = static_cast<const char*>(p);
+            total += n;
+
+            while (n)
+            {
+                // a write at least as large as the buffer bypasses it once the buffer is drained
+                if (!used && n >= size)
+                {
+                    std::invoke(f, q, n);
+
+                    return 1;
+                }
+
+                size_t k = std::min(n, size - used);
+                std::memcpy(buff.get() + used, q, k);
+
+                q += k;
+                n -= k;
+
+                if ((used += k) == size)
+                    flush();
+            }
+
+            return 1;
+        }
+
+        void flush()
+        {
+            if (used)
+                std::invoke(f, std::as_const(buff).get(), std::exchange(used, 0));
+        }
+
+        size_t length() const noexcept
+        {
+            return total;
+        }
+
+        F f;
+        std::unique_ptr<char[]> buff;
+
+        size_t size;
+        size_t used = 0;
+
+        size_t total = 0;
+    };
+}
+
+#endif
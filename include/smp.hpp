@@ -12,5 +12,10 @@
 
 #include <indexer.hpp>
 #include <reflect.hpp>
+#include <decoder.hpp>
+#include <record.hpp>
+#include <codec.hpp>
+#include <frame.hpp>
+#include <parallel.hpp>
 
 #endif
@@ -60,6 +60,20 @@ namespace smp
             return addressof<N, U>() - addressof<0, U>();
         }
 
+        template <size_t N>
+        static constexpr size_t position() noexcept
+        {
+            if constexpr(N == 0)
+                return 0;
+            else
+            {
+                constexpr size_t a = alignof(fuple_element_t<N, type>);
+                constexpr size_t p = position<N - 1>() + sizeof(fuple_element_t<N - 1, type>);
+
+                return (p + a - 1) / a * a;
+            }
+        }
+
         template <size_t N, typename U>
         requires (!is_fuple_v<std::remove_cvref_t<U>>)
         constexpr decltype(auto) get(U&& u) noexcept